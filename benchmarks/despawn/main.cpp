@@ -0,0 +1,113 @@
+#include "allocator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Compares removing entities one at a time with removing them in one batch
+// and with removing every entity in a query. A few edges are kept alive so
+// that edge cleanup isn't free.
+
+struct pos_t
+{
+   float values[3];
+};
+
+struct vel_t
+{
+   float values[3];
+};
+
+struct particle_t
+{
+   float lifetime;
+};
+
+double nanosecondsPerEntity(
+   std::chrono::steady_clock::time_point start, size_t num_entities
+)
+{
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+   return std::chrono::duration<double, std::nano>(elapsed).count() / num_entities;
+}
+
+// Fills an allocator with particles and a handful of edges between
+// non-particle entities. Returns the particles in random order.
+std::vector<trecs::uid_t> fill(trecs::Allocator & allocator, size_t num_particles)
+{
+   allocator.registerComponent<pos_t>();
+   allocator.registerComponent<vel_t>();
+   allocator.registerComponent<particle_t>();
+
+   const pos_t pos = {{0.f, 0.f, 0.f}};
+   const vel_t vel = {{0.f, 1.f, 0.f}};
+   const particle_t particle = {1.f};
+
+   std::vector<trecs::uid_t> particles = allocator.spawn(
+      num_particles, pos, vel, particle
+   );
+
+   const std::vector<trecs::uid_t> bodies = allocator.spawn(64, pos, vel);
+   for (size_t i = 0; i + 1 < bodies.size(); i += 2)
+   {
+      allocator.addEntity(bodies[i], bodies[i + 1]);
+   }
+
+   std::mt19937 rng(12345);
+   std::shuffle(particles.begin(), particles.end(), rng);
+
+   return particles;
+}
+
+int main(void)
+{
+   const size_t particle_counts[] = {1000, 10000, 50000};
+
+   std::cout << "particles, removeEntity ns, removeEntities ns, query removeEntities ns\n";
+
+   for (const auto num_particles : particle_counts)
+   {
+      double results[3];
+
+      {
+         trecs::Allocator allocator(num_particles + 256);
+         const std::vector<trecs::uid_t> particles = fill(allocator, num_particles);
+
+         auto start = std::chrono::steady_clock::now();
+         for (const auto particle : particles)
+         {
+            allocator.removeEntity(particle);
+         }
+         results[0] = nanosecondsPerEntity(start, num_particles);
+      }
+
+      {
+         trecs::Allocator allocator(num_particles + 256);
+         const std::vector<trecs::uid_t> particles = fill(allocator, num_particles);
+
+         auto start = std::chrono::steady_clock::now();
+         allocator.removeEntities(
+            trecs::Span<const trecs::uid_t>(particles.data(), particles.size())
+         );
+         results[1] = nanosecondsPerEntity(start, num_particles);
+      }
+
+      {
+         trecs::Allocator allocator(num_particles + 256);
+         allocator.registerComponent<particle_t>();
+         fill(allocator, num_particles);
+         const trecs::query_t particle_query = allocator.addArchetypeQuery<particle_t>();
+
+         auto start = std::chrono::steady_clock::now();
+         allocator.removeEntities(particle_query);
+         results[2] = nanosecondsPerEntity(start, num_particles);
+      }
+
+      std::cout << num_particles << ", " << results[0] << ", " << results[1] << ", " << results[2] << "\n";
+   }
+
+   return 0;
+}
@@ -0,0 +1,106 @@
+#include "allocator.hpp"
+#include "entity_manager.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Measures the per-call cost of entity creation, entity liveness checks, and
+// the allocator operations that depend on them, at increasing entity counts.
+// The cost per call should stay flat as the number of entities grows.
+
+struct payload_t
+{
+   float values[4];
+};
+
+double nanosecondsPerCall(
+   std::chrono::steady_clock::time_point start, size_t num_calls
+)
+{
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+   return std::chrono::duration<double, std::nano>(elapsed).count() / num_calls;
+}
+
+int main(void)
+{
+   const size_t entity_counts[] = {1000, 10000, 100000, 200000, 2000000};
+   const size_t num_calls = 2000000;
+
+   std::cout << "entities, addEntity ns, entityActive ns, hasComponent ns, getComponent ns, removeEntity ns\n";
+
+   for (const auto num_entities : entity_counts)
+   {
+      trecs::EntityManager entity_manager(num_entities + 1);
+      trecs::Allocator allocator(num_entities + 1);
+      allocator.registerComponent<payload_t>();
+
+      auto start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < num_entities; ++i)
+      {
+         entity_manager.addEntity();
+      }
+      const double add_ns = nanosecondsPerCall(start, num_entities);
+
+      std::vector<trecs::uid_t> entities;
+      entities.reserve(num_entities);
+      for (size_t i = 0; i < num_entities; ++i)
+      {
+         entities.push_back(allocator.addEntity());
+         allocator.addComponent(entities.back(), payload_t{{1.f, 2.f, 3.f, 4.f}});
+      }
+
+      std::mt19937 rng(12345);
+      std::uniform_int_distribution<size_t> pick(0, num_entities - 1);
+      std::vector<trecs::uid_t> lookups(num_calls);
+      for (auto & lookup : lookups)
+      {
+         lookup = entities[pick(rng)];
+      }
+
+      // Results are accumulated so that the calls aren't optimized away.
+      size_t checksum = 0;
+
+      start = std::chrono::steady_clock::now();
+      for (const auto entity : lookups)
+      {
+         checksum += entity_manager.entityActive(entity);
+      }
+      const double active_ns = nanosecondsPerCall(start, num_calls);
+
+      start = std::chrono::steady_clock::now();
+      for (const auto entity : lookups)
+      {
+         checksum += allocator.hasComponent<payload_t>(entity);
+      }
+      const double has_ns = nanosecondsPerCall(start, num_calls);
+
+      float sum = 0.f;
+      start = std::chrono::steady_clock::now();
+      for (const auto entity : lookups)
+      {
+         sum += allocator.getComponent<payload_t>(entity)->values[2];
+      }
+      const double get_ns = nanosecondsPerCall(start, num_calls);
+
+      // Remove half of the entities in random order.
+      std::shuffle(entities.begin(), entities.end(), rng);
+      const size_t num_removed = num_entities / 2;
+      start = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < num_removed; ++i)
+      {
+         allocator.removeEntity(entities[i]);
+      }
+      const double remove_ns = nanosecondsPerCall(start, num_removed);
+
+      checksum += static_cast<size_t>(sum);
+
+      std::cout << num_entities << ", " << add_ns << ", " << active_ns << ", " << has_ns << ", ";
+      std::cout << get_ns << ", " << remove_ns << "    (checksum " << checksum << ")\n";
+   }
+
+   return 0;
+}
@@ -0,0 +1,122 @@
+#include "query_manager.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Measures the cost of moving an entity between archetypes that differ by one
+// signature, with an increasing number of registered queries. Only the
+// queries that mention the changed signature should be examined, so the cost
+// per move should grow far slower than the number of queries.
+//
+// Cold moves toggle any signature, so almost every move reaches a new
+// archetype. Warm moves toggle a few signatures, so entities revisit the same
+// archetypes and follow cached edges of the archetype graph.
+
+double nanosecondsPerCall(
+   std::chrono::steady_clock::time_point start, size_t num_calls
+)
+{
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+   return std::chrono::duration<double, std::nano>(elapsed).count() / num_calls;
+}
+
+// Toggles one signature per move, cycling through the entities. Returns the
+// nanoseconds per move.
+double moveEntities(
+   trecs::QueryManager & queries,
+   std::vector<trecs::DefaultArchetype> & entity_archs,
+   const std::vector<trecs::signature_t> & toggles
+)
+{
+   const auto start = std::chrono::steady_clock::now();
+   for (size_t i = 0; i < toggles.size(); ++i)
+   {
+      const size_t entity = i % entity_archs.size();
+      trecs::DefaultArchetype new_arch = entity_archs[entity];
+      if (new_arch.supports(toggles[i]))
+      {
+         new_arch.removeSignature(toggles[i]);
+      }
+      else
+      {
+         new_arch.mergeSignature(toggles[i]);
+      }
+
+      queries.moveEntity(entity, entity_archs[entity], new_arch);
+      entity_archs[entity] = new_arch;
+   }
+
+   return nanosecondsPerCall(start, toggles.size());
+}
+
+int main(void)
+{
+   const size_t query_counts[] = {10, 100, 500, 2000};
+   const size_t num_entities = 1000;
+   const size_t num_moves = 200000;
+
+   std::cout << "queries, cold moveEntity ns, warm moveEntity ns\n";
+
+   for (const auto num_queries : query_counts)
+   {
+      std::mt19937 rng(12345);
+      std::uniform_int_distribution<int> pick_sig(0, trecs::max_num_signatures - 1);
+
+      trecs::QueryManager queries;
+      for (size_t i = 0; i < num_queries; ++i)
+      {
+         trecs::DefaultArchetype arch;
+         const size_t num_sigs = 1 + (i % 4);
+         for (size_t j = 0; j < num_sigs; ++j)
+         {
+            arch.mergeSignature(pick_sig(rng));
+         }
+         queries.addArchetypeQuery(arch);
+      }
+
+      // Every entity starts with a handful of signatures.
+      std::vector<trecs::DefaultArchetype> entity_archs(num_entities);
+      for (size_t i = 0; i < num_entities; ++i)
+      {
+         for (int j = 0; j < 8; ++j)
+         {
+            entity_archs[i].mergeSignature(pick_sig(rng));
+         }
+         queries.moveEntity(i, trecs::DefaultArchetype(), entity_archs[i]);
+      }
+
+      std::vector<trecs::signature_t> cold_toggles(num_moves);
+      for (auto & sig : cold_toggles)
+      {
+         sig = pick_sig(rng);
+      }
+
+      std::uniform_int_distribution<int> pick_warm_sig(0, 5);
+      std::vector<trecs::signature_t> warm_toggles(num_moves);
+      for (auto & sig : warm_toggles)
+      {
+         sig = pick_warm_sig(rng);
+      }
+
+      const double cold_ns = moveEntities(queries, entity_archs, cold_toggles);
+
+      // Entities share a few starting archetypes for the warm moves. The
+      // first pass builds the warm archetypes and edges.
+      for (size_t i = 0; i < num_entities; ++i)
+      {
+         const trecs::DefaultArchetype warm_arch = entity_archs[i % 8];
+         queries.moveEntity(i, entity_archs[i], warm_arch);
+         entity_archs[i] = warm_arch;
+      }
+
+      moveEntities(queries, entity_archs, warm_toggles);
+      const double warm_ns = moveEntities(queries, entity_archs, warm_toggles);
+
+      std::cout << num_queries << ", " << cold_ns << ", " << warm_ns << "\n";
+   }
+
+   return 0;
+}
@@ -0,0 +1,113 @@
+#include "allocator.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+// Compares three ways of writing a three-component system update: fetching
+// each component through the allocator, indexing component wrappers by UID,
+// and visiting the entities through a typed query view. The view also
+// records writes to its two non-const components for change detection.
+
+struct pos_t
+{
+   float values[3];
+};
+
+struct vel_t
+{
+   float values[3];
+};
+
+struct acc_t
+{
+   float values[3];
+};
+
+double nanosecondsPerEntity(
+   std::chrono::steady_clock::time_point start, size_t num_entities
+)
+{
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+   return std::chrono::duration<double, std::nano>(elapsed).count() / num_entities;
+}
+
+void integrate(pos_t & pos, vel_t & vel, const acc_t & acc)
+{
+   for (int i = 0; i < 3; ++i)
+   {
+      vel.values[i] += 0.01f * acc.values[i];
+      pos.values[i] += 0.01f * vel.values[i];
+   }
+}
+
+int main(void)
+{
+   const size_t entity_counts[] = {1000, 10000, 100000};
+   const size_t num_updates = 20;
+
+   std::cout << "entities, getComponent ns, wrappers ns, view ns\n";
+
+   for (const auto num_entities : entity_counts)
+   {
+      trecs::Allocator allocator(num_entities + 1);
+      allocator.registerComponent<pos_t>();
+      allocator.registerComponent<vel_t>();
+      allocator.registerComponent<acc_t>();
+
+      const trecs::query_t query = allocator.addArchetypeQuery<pos_t, vel_t, acc_t>();
+
+      const pos_t pos = {{0.f, 0.f, 0.f}};
+      const vel_t vel = {{1.f, 0.f, 0.f}};
+      const acc_t acc = {{0.f, -9.8f, 0.f}};
+      allocator.spawn(num_entities, pos, vel, acc);
+
+      auto start = std::chrono::steady_clock::now();
+      for (size_t update = 0; update < num_updates; ++update)
+      {
+         for (const auto entity : allocator.getQueryEntities(query))
+         {
+            integrate(
+               *allocator.getComponent<pos_t>(entity),
+               *allocator.getComponent<vel_t>(entity),
+               *allocator.getComponent<acc_t>(entity)
+            );
+         }
+      }
+      const double get_ns = nanosecondsPerEntity(start, num_updates * num_entities);
+
+      start = std::chrono::steady_clock::now();
+      for (size_t update = 0; update < num_updates; ++update)
+      {
+         auto positions = allocator.getComponents<pos_t>();
+         auto velocities = allocator.getComponents<vel_t>();
+         auto accelerations = allocator.getComponents<acc_t>();
+         for (const auto entity : allocator.getQueryEntities(query))
+         {
+            integrate(
+               *positions[entity], *velocities[entity], *accelerations[entity]
+            );
+         }
+      }
+      const double wrapper_ns = nanosecondsPerEntity(start, num_updates * num_entities);
+
+      start = std::chrono::steady_clock::now();
+      for (size_t update = 0; update < num_updates; ++update)
+      {
+         allocator.view<pos_t, vel_t, const acc_t>(query).each(
+            [](trecs::uid_t, pos_t & pos, vel_t & vel, const acc_t & acc)
+            {
+               integrate(pos, vel, acc);
+            }
+         );
+      }
+      const double view_ns = nanosecondsPerEntity(start, num_updates * num_entities);
+
+      // Reading a result keeps the updates from being optimized away.
+      const trecs::uid_t first = allocator.getQueryEntities(query)[0];
+      std::cout << num_entities << ", " << get_ns << ", " << wrapper_ns << ", " << view_ns;
+      std::cout << "    (y " << allocator.getComponent<pos_t>(first)->values[1] << ")\n";
+   }
+
+   return 0;
+}
@@ -0,0 +1,113 @@
+#include "allocator.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+// Compares spawning entities one component at a time with spawning them in
+// one batch, with a handful of queries registered. The batch should scale
+// with the number of entities, not with entities times queries.
+
+struct pos_t
+{
+   float values[3];
+};
+
+struct vel_t
+{
+   float values[3];
+};
+
+struct mass_t
+{
+   float value;
+};
+
+struct health_t
+{
+   int value;
+};
+
+double nanosecondsPerEntity(
+   std::chrono::steady_clock::time_point start, size_t num_entities
+)
+{
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+   return std::chrono::duration<double, std::nano>(elapsed).count() / num_entities;
+}
+
+void registerAll(trecs::Allocator & allocator)
+{
+   allocator.registerComponent<pos_t>();
+   allocator.registerComponent<vel_t>();
+   allocator.registerComponent<mass_t>();
+   allocator.registerComponent<health_t>();
+
+   allocator.addArchetypeQuery<pos_t>();
+   allocator.addArchetypeQuery<pos_t, vel_t>();
+   allocator.addArchetypeQuery<pos_t, vel_t, mass_t>();
+   allocator.addArchetypeQuery<health_t>();
+   allocator.addArchetypeQuery<mass_t, health_t>();
+}
+
+int main(void)
+{
+   const size_t entity_counts[] = {1000, 10000, 100000};
+
+   const pos_t pos = {{1.f, 2.f, 3.f}};
+   const vel_t vel = {{0.f, 0.f, 1.f}};
+   const mass_t mass = {2.f};
+   const health_t health = {100};
+
+   std::cout << "entities, addComponent ns, spawn ns, chunk addComponent ns, chunk spawn ns\n";
+
+   for (const auto num_entities : entity_counts)
+   {
+      double results[4];
+
+      for (int mode = 0; mode < 2; ++mode)
+      {
+         const trecs::component_storage_enum_t storage = (mode == 0) ? \
+            trecs::PER_TYPE_POOLS : trecs::ARCHETYPE_CHUNKS;
+
+         {
+            trecs::Allocator allocator(num_entities + 1, storage);
+            registerAll(allocator);
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < num_entities; ++i)
+            {
+               const trecs::uid_t entity = allocator.addEntity();
+               allocator.addComponent(entity, pos);
+               allocator.addComponent(entity, vel);
+               allocator.addComponent(entity, mass);
+               allocator.addComponent(entity, health);
+            }
+            results[2 * mode] = nanosecondsPerEntity(start, num_entities);
+         }
+
+         {
+            trecs::Allocator allocator(num_entities + 1, storage);
+            registerAll(allocator);
+
+            auto start = std::chrono::steady_clock::now();
+            const std::vector<trecs::uid_t> entities = allocator.spawn(
+               num_entities, pos, vel, mass, health
+            );
+            results[2 * mode + 1] = nanosecondsPerEntity(start, num_entities);
+
+            if (entities.size() != num_entities)
+            {
+               std::cout << "Spawned " << entities.size() << " entities instead of " << num_entities << "\n";
+               return 1;
+            }
+         }
+      }
+
+      std::cout << num_entities << ", " << results[0] << ", " << results[1] << ", ";
+      std::cout << results[2] << ", " << results[3] << "\n";
+   }
+
+   return 0;
+}
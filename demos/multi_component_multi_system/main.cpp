@@ -1,5 +1,6 @@
 #include "allocator.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -58,6 +59,28 @@ struct named_vec3
    }
 };
 
+// Stores every named_vec3 type as three float columns, so the integrator
+// can run over x, y, and z without gathering them from structs.
+namespace trecs
+{
+   template <unsigned int JankyName>
+   struct SoaTraits<named_vec3<JankyName> >
+   {
+      static const bool enabled = true;
+      static const size_t num_fields = 3;
+
+      static float getField(const named_vec3<JankyName> & v, size_t field)
+      {
+         return v[static_cast<int>(field)];
+      }
+
+      static void setField(named_vec3<JankyName> & v, size_t field, float value)
+      {
+         v[static_cast<int>(field)] = value;
+      }
+   };
+}
+
 typedef named_vec3<0> pos_t;
 typedef named_vec3<1> vel_t;
 typedef named_vec3<2> acc_t;
@@ -140,9 +163,6 @@ class ForceCalculator : public trecs::System
 
          auto force_edges = allocator.getComponents<trecs::edge_t>();
          auto forces = allocator.getComponents<spring_damper_t>();
-         auto positions = allocator.getComponents<pos_t>();
-         auto velocities = allocator.getComponents<vel_t>();
-         auto accelerations = allocator.getComponents<acc_t>();
 
          for (const auto & force_entity : force_entities)
          {
@@ -150,8 +170,10 @@ class ForceCalculator : public trecs::System
             auto body_a_entity = force_edges[force_entity]->nodeIdA;
             auto body_b_entity = force_edges[force_entity]->nodeIdB;
 
-            pos_t & pos_a = *positions[body_a_entity];
-            pos_t & pos_b = *positions[body_b_entity];
+            pos_t pos_a;
+            pos_t pos_b;
+            allocator.readComponent(body_a_entity, pos_a);
+            allocator.readComponent(body_b_entity, pos_b);
 
             float distance = sqrtf(
                powf(pos_a.vec[0] - pos_b.vec[0], 2.f) +
@@ -159,11 +181,13 @@ class ForceCalculator : public trecs::System
                powf(pos_a.vec[2] - pos_b.vec[2], 2.f)
             );
 
-            vel_t & vel_a = *velocities[body_a_entity];
-            vel_t & vel_b = *velocities[body_b_entity];
+            vel_t vel_a;
+            vel_t vel_b;
+            allocator.readComponent(body_a_entity, vel_a);
+            allocator.readComponent(body_b_entity, vel_b);
 
-            acc_t & accel_a = *accelerations[body_a_entity];
-            acc_t & accel_b = *accelerations[body_b_entity];
+            acc_t accel_a;
+            acc_t accel_b;
 
             for (int i = 0; i < 3; ++i)
             {
@@ -176,6 +200,9 @@ class ForceCalculator : public trecs::System
                accel_a.vec[i] = f_b_on_a;
                accel_b.vec[i] = -1.f * f_b_on_a;
             }
+
+            allocator.updateComponent(body_a_entity, accel_a);
+            allocator.updateComponent(body_b_entity, accel_b);
          }
       }
 
@@ -202,28 +229,32 @@ class Integrator : public trecs::System
 
       void update(trecs::Allocator & allocator)
       {
-         const auto & point_mass_entities = allocator.getQueryEntities(point_mass_query_);
-         auto positions = allocator.getComponents<pos_t>();
-         auto velocities = allocator.getComponents<vel_t>();
-         auto accelerations = allocator.getComponents<acc_t>();
-
-         for (const auto entity : point_mass_entities)
+         auto positions = allocator.getSoaComponents<pos_t>();
+         auto velocities = allocator.getSoaComponents<vel_t>();
+         auto accelerations = allocator.getSoaComponents<acc_t>();
+
+         // Every point mass has all three components and none of them are
+         // ever removed, so the columns line up. The padded tails are zero,
+         // so the loops can run over them.
+         if (
+            !sameOrder(positions.uids(), velocities.uids()) ||
+            !sameOrder(positions.uids(), accelerations.uids())
+         )
          {
-            vel_t & vel = *velocities[entity];
-            acc_t & acc = *accelerations[entity];
-            for (int i = 0; i < 3; ++i)
-            {
-               vel.vec[i] += acc.vec[i] * dt_;
-            }
+            std::cout << "Point mass columns are out of order\n";
+            return;
          }
 
-         for (const auto entity : point_mass_entities)
+         for (size_t field = 0; field < 3; ++field)
          {
-            pos_t & pos = *positions[entity];
-            vel_t & vel = *velocities[entity];
-            for (int i = 0; i < 3; ++i)
+            float * pos = positions.column(field);
+            float * vel = velocities.column(field);
+            const float * acc = accelerations.column(field);
+
+            for (size_t i = 0; i < positions.paddedSize(); ++i)
             {
-               pos.vec[i] += vel.vec[i] * dt_;
+               vel[i] += acc[i] * dt_;
+               pos[i] += vel[i] * dt_;
             }
          }
       }
@@ -232,6 +263,13 @@ class Integrator : public trecs::System
       trecs::query_t point_mass_query_;
 
       const float dt_ = 0.001f;
+
+      static bool sameOrder(
+         trecs::Span<const trecs::uid_t> a, trecs::Span<const trecs::uid_t> b
+      )
+      {
+         return (a.size() == b.size()) && std::equal(a.begin(), a.end(), b.begin());
+      }
 };
 
 int main(void)
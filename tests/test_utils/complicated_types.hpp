@@ -38,4 +38,96 @@ typedef struct byteChecker_s
 
 } byteChecker_t;
 
+// Counts constructions, copies, moves, and destructions so that tests can
+// verify how containers manage component lifetimes. The heap-allocated
+// payload makes copies observably more expensive than moves.
+template <unsigned int N>
+struct lifetimeCounter_t
+{
+   static int num_alive;
+   static int num_copies;
+   static int num_moves;
+
+   static void resetCounts(void)
+   {
+      num_alive = 0;
+      num_copies = 0;
+      num_moves = 0;
+   }
+
+   lifetimeCounter_t(void)
+      : payload(new int(0))
+   {
+      ++num_alive;
+   }
+
+   explicit lifetimeCounter_t(int value)
+      : payload(new int(value))
+   {
+      ++num_alive;
+   }
+
+   lifetimeCounter_t(const lifetimeCounter_t<N> & other)
+      : payload(new int(other.value()))
+   {
+      ++num_alive;
+      ++num_copies;
+   }
+
+   lifetimeCounter_t(lifetimeCounter_t<N> && other)
+      : payload(other.payload)
+   {
+      other.payload = nullptr;
+      ++num_alive;
+      ++num_moves;
+   }
+
+   ~lifetimeCounter_t(void)
+   {
+      delete payload;
+      --num_alive;
+   }
+
+   lifetimeCounter_t<N> & operator=(const lifetimeCounter_t<N> & other)
+   {
+      if (this != &other)
+      {
+         delete payload;
+         payload = new int(other.value());
+         ++num_copies;
+      }
+
+      return *this;
+   }
+
+   lifetimeCounter_t<N> & operator=(lifetimeCounter_t<N> && other)
+   {
+      if (this != &other)
+      {
+         delete payload;
+         payload = other.payload;
+         other.payload = nullptr;
+         ++num_moves;
+      }
+
+      return *this;
+   }
+
+   int value(void) const
+   {
+      return (payload == nullptr) ? -1 : *payload;
+   }
+
+   int * payload;
+};
+
+template <unsigned int N>
+int lifetimeCounter_t<N>::num_alive = 0;
+
+template <unsigned int N>
+int lifetimeCounter_t<N>::num_copies = 0;
+
+template <unsigned int N>
+int lifetimeCounter_t<N>::num_moves = 0;
+
 #endif
@@ -9,6 +9,37 @@
 
 #include <vector>
 
+// An empty component that's only stored in entity archetypes.
+struct sleepingTag_t
+{ };
+
+// A component that's stored in structure-of-arrays columns.
+struct soaPoint_t
+{
+   float x;
+   float y;
+};
+
+namespace trecs
+{
+   template <>
+   struct SoaTraits<soaPoint_t>
+   {
+      static const bool enabled = true;
+      static const size_t num_fields = 2;
+
+      static float getField(const soaPoint_t & point, size_t field)
+      {
+         return (field == 0) ? point.x : point.y;
+      }
+
+      static void setField(soaPoint_t & point, size_t field, float value)
+      {
+         (field == 0) ? (point.x = value) : (point.y = value);
+      }
+   };
+}
+
 TEST_CASE( "two components can't be added to one entity", "[Allocator]")
 {
    complicatedType_t<0> comp_a;
@@ -533,3 +564,1047 @@ TEST_CASE( "add multiple templatized ECB's", "[Allocator]" )
    REQUIRE( ecb_component_a->supportsComponents<float, int, char>() );
    REQUIRE( ecb_component_b->supportsComponents<complicatedType_t<0>, complicatedType_t<8>, complicatedType_t<13> >() );
 }
+
+TEST_CASE( "archetype chunk storage supports components, edges, and ECB's", "[Allocator]" )
+{
+   trecs::Allocator allocator(256, trecs::ARCHETYPE_CHUNKS);
+
+   REQUIRE( allocator.storageMode() == trecs::ARCHETYPE_CHUNKS );
+
+   allocator.registerComponent<int>();
+   allocator.registerComponent<float>();
+
+   trecs::uid_t node_a = allocator.addEntity();
+   REQUIRE( allocator.addComponent(node_a, 3) );
+   REQUIRE( allocator.addComponent(node_a, 1.5f) );
+   REQUIRE( !allocator.addComponent(node_a, 4) );
+
+   trecs::uid_t node_b = allocator.addEntity();
+   REQUIRE( allocator.updateComponent(node_b, 7) );
+   REQUIRE( allocator.updateComponent(node_b, 8) );
+
+   REQUIRE( *allocator.getComponent<int>(node_a) == 3 );
+   REQUIRE( *allocator.getComponent<float>(node_a) == 1.5f );
+   REQUIRE( *allocator.getComponent<int>(node_b) == 8 );
+   REQUIRE( allocator.getComponent<float>(node_b) == nullptr );
+
+   auto ints = allocator.getComponents<int>();
+   REQUIRE( ints.size() == 2 );
+   REQUIRE( *ints[node_a] == 3 );
+
+   trecs::uid_t edge_entity = allocator.addEntity(node_a, node_b);
+   REQUIRE( allocator.getEdge(edge_entity).nodeIdA == node_a );
+
+   allocator.removeEntity(node_a);
+   REQUIRE( allocator.getEdge(edge_entity).nodeIdA == -1 );
+   REQUIRE( allocator.getEdge(edge_entity).flag == trecs::edge_flag_enum_t::NODE_A_TERMINAL );
+
+   allocator.removeComponent<int>(node_b);
+   REQUIRE( !allocator.hasComponent<int>(node_b) );
+   REQUIRE( allocator.getComponents<int>().size() == 0 );
+
+   trecs::uid_t ecb_entity = allocator.addEntityComponentBuffer<int, float>(16);
+   trecs::EntityComponentBuffer * ecb = allocator.getEntityComponentBuffer(ecb_entity);
+   REQUIRE( ecb != nullptr );
+
+   trecs::uid_t ecb_sub_entity = ecb->addEntity();
+   REQUIRE( ecb->updateComponent(ecb_sub_entity, 12) );
+   REQUIRE( *ecb->getComponent<int>(ecb_sub_entity) == 12 );
+}
+
+TEST_CASE( "archetype chunk storage iterates query results chunk by chunk", "[Allocator]" )
+{
+   trecs::Allocator allocator(2048, trecs::ARCHETYPE_CHUNKS);
+
+   allocator.registerComponent<int>();
+   allocator.registerComponent<float>();
+   allocator.registerComponent<complicatedType_t<0> >();
+
+   trecs::query_t int_float_query = allocator.addArchetypeQuery<int, float>();
+
+   for (int i = 0; i < 1500; ++i)
+   {
+      trecs::uid_t entity = allocator.addEntity();
+      allocator.addComponent(entity, static_cast<int>(entity));
+      allocator.addComponent(entity, 0.25f * entity);
+
+      if ((i % 2) == 0)
+      {
+         allocator.addComponent(entity, complicatedType_t<0>{i, 1.f});
+      }
+   }
+
+   const auto chunks = allocator.getQueryChunks(int_float_query);
+   REQUIRE( chunks.size() > 2 );
+
+   size_t num_entities = 0;
+   for (const auto chunk : chunks)
+   {
+      const auto uids = chunk->uids();
+      auto int_column = allocator.getChunkComponents<int>(*chunk);
+      auto float_column = allocator.getChunkComponents<float>(*chunk);
+
+      REQUIRE( int_column.size() == chunk->size() );
+      REQUIRE( float_column.size() == chunk->size() );
+
+      for (size_t i = 0; i < chunk->size(); ++i)
+      {
+         REQUIRE( int_column[i] == uids[i] );
+         REQUIRE( float_column[i] == 0.25f * uids[i] );
+      }
+
+      num_entities += chunk->size();
+   }
+
+   REQUIRE( num_entities == allocator.getQueryEntities(int_float_query).size() );
+   REQUIRE( num_entities == 1500 );
+}
+
+TEST_CASE( "per-type pool storage has no query chunks", "[Allocator]" )
+{
+   trecs::Allocator allocator(128);
+
+   allocator.registerComponent<int>();
+   trecs::query_t int_query = allocator.addArchetypeQuery<int>();
+
+   allocator.addComponent(allocator.addEntity(), 5);
+
+   REQUIRE( allocator.storageMode() == trecs::PER_TYPE_POOLS );
+   REQUIRE( allocator.getQueryChunks(int_query).empty() );
+   REQUIRE( allocator.getQueryEntities(int_query).size() == 1 );
+}
+
+TEST_CASE( "allocator components and ECB's come from one arena", "[Allocator]" )
+{
+   trecs::ArenaMemoryResource arena(8 << 20);
+
+   {
+      trecs::Allocator allocator(1024, trecs::PER_TYPE_POOLS, &arena);
+      REQUIRE( allocator.memoryResource() == &arena );
+
+      allocator.registerComponent<int>();
+      allocator.registerComponent<complicatedType_t<2> >();
+
+      trecs::uid_t entity = allocator.addEntity();
+      allocator.addComponent(entity, 17);
+      allocator.addComponent(entity, complicatedType_t<2>{3, 4.f});
+
+      REQUIRE( arena.owns(allocator.getComponent<int>(entity)) );
+      REQUIRE( arena.owns(allocator.getComponent<complicatedType_t<2> >(entity)) );
+
+      trecs::uid_t ecb_entity = allocator.addEntityComponentBuffer<int>(16);
+      trecs::EntityComponentBuffer * ecb = allocator.getEntityComponentBuffer(ecb_entity);
+      REQUIRE( ecb != nullptr );
+
+      trecs::uid_t ecb_sub_entity = ecb->addEntity();
+      REQUIRE( ecb->updateComponent(ecb_sub_entity, 5) );
+      REQUIRE( arena.owns(ecb->getComponent<int>(ecb_sub_entity)) );
+      REQUIRE( *ecb->getComponent<int>(ecb_sub_entity) == 5 );
+   }
+
+   REQUIRE( arena.numUpstreamAllocations() == 0 );
+   arena.release();
+}
+
+TEST_CASE( "archetype chunks come from an arena", "[Allocator]" )
+{
+   trecs::ArenaMemoryResource arena(8 << 20);
+
+   {
+      trecs::Allocator allocator(1024, trecs::ARCHETYPE_CHUNKS, &arena);
+
+      allocator.registerComponent<int>();
+
+      for (int i = 0; i < 100; ++i)
+      {
+         trecs::uid_t entity = allocator.addEntity();
+         allocator.addComponent(entity, i);
+         REQUIRE( arena.owns(allocator.getComponent<int>(entity)) );
+      }
+   }
+
+   arena.release();
+}
+
+TEST_CASE( "components can be emplaced and moved onto entities", "[Allocator]" )
+{
+   typedef lifetimeCounter_t<1> counter_t;
+   counter_t::resetCounts();
+
+   {
+      trecs::Allocator allocator(64);
+      allocator.registerComponent<counter_t>();
+
+      trecs::uid_t entity_a = allocator.addEntity();
+      trecs::uid_t entity_b = allocator.addEntity();
+      trecs::uid_t entity_c = allocator.addEntity();
+
+      REQUIRE( allocator.emplaceComponent<counter_t>(entity_a, 3) );
+      REQUIRE( allocator.addComponent(entity_b, counter_t(4)) );
+      REQUIRE( allocator.updateComponent(entity_c, counter_t(5)) );
+
+      REQUIRE( counter_t::num_copies == 0 );
+      REQUIRE( counter_t::num_alive == 3 );
+
+      // Emplacing over an existing component fails.
+      REQUIRE( !allocator.emplaceComponent<counter_t>(entity_a, 6) );
+      REQUIRE( allocator.getComponent<counter_t>(entity_a)->value() == 3 );
+
+      // Updating an existing component with an rvalue move-assigns it.
+      REQUIRE( allocator.updateComponent(entity_a, counter_t(7)) );
+      REQUIRE( allocator.getComponent<counter_t>(entity_a)->value() == 7 );
+      REQUIRE( counter_t::num_copies == 0 );
+      REQUIRE( counter_t::num_alive == 3 );
+
+      allocator.removeComponent<counter_t>(entity_a);
+      REQUIRE( counter_t::num_alive == 2 );
+      REQUIRE( allocator.getComponent<counter_t>(entity_b)->value() == 4 );
+      REQUIRE( allocator.getComponent<counter_t>(entity_c)->value() == 5 );
+
+      allocator.removeEntity(entity_b);
+      REQUIRE( counter_t::num_alive == 1 );
+      REQUIRE( counter_t::num_copies == 0 );
+   }
+
+   REQUIRE( counter_t::num_alive == 0 );
+}
+
+TEST_CASE( "soa components are stored in columns", "[Allocator]" )
+{
+   for (int mode = 0; mode < 2; ++mode)
+   {
+      const trecs::component_storage_enum_t storage = (mode == 0) ? \
+         trecs::PER_TYPE_POOLS : trecs::ARCHETYPE_CHUNKS;
+
+      trecs::Allocator allocator(256, storage);
+      allocator.registerComponent<soaPoint_t>();
+      allocator.registerComponent<int>();
+
+      trecs::query_t query = allocator.addArchetypeQuery<soaPoint_t, int>();
+
+      std::vector<trecs::uid_t> entities;
+      for (int i = 0; i < 40; ++i)
+      {
+         trecs::uid_t entity = allocator.addEntity();
+         entities.push_back(entity);
+
+         soaPoint_t point;
+         point.x = static_cast<float>(i);
+         point.y = -static_cast<float>(i);
+         REQUIRE( allocator.addComponent(entity, point) );
+         REQUIRE( !allocator.addComponent(entity, point) );
+         REQUIRE( allocator.addComponent(entity, i) );
+      }
+
+      REQUIRE( allocator.getQueryEntities(query).size() == 40 );
+      REQUIRE( allocator.hasComponent<soaPoint_t>(entities[5]) );
+
+      soaPoint_t point;
+      REQUIRE( allocator.readComponent(entities[5], point) );
+      REQUIRE( point.x == 5.f );
+      REQUIRE( point.y == -5.f );
+
+      point.x = 100.f;
+      REQUIRE( allocator.updateComponent(entities[5], point) );
+
+      // Every entity can be reached through the columns.
+      trecs::SoaView<soaPoint_t> view = allocator.getSoaComponents<soaPoint_t>();
+      REQUIRE( view.size() == 40 );
+      for (size_t i = 0; i < view.size(); ++i)
+      {
+         int value = 0;
+         REQUIRE( allocator.readComponent(view.uids()[i], value) );
+         const float expected_x = (value == 5) ? 100.f : static_cast<float>(value);
+         REQUIRE( view.column(0)[i] == expected_x );
+         REQUIRE( view.column(1)[i] == -static_cast<float>(value) );
+      }
+
+      allocator.removeComponent<soaPoint_t>(entities[0]);
+      allocator.removeEntity(entities[1]);
+
+      REQUIRE( !allocator.hasComponent<soaPoint_t>(entities[0]) );
+      REQUIRE( !allocator.readComponent(entities[0], point) );
+      REQUIRE( allocator.getSoaComponents<soaPoint_t>().size() == 38 );
+      REQUIRE( allocator.getQueryEntities(query).size() == 38 );
+   }
+}
+
+TEST_CASE( "tag components only live in archetypes", "[Allocator]" )
+{
+   for (int mode = 0; mode < 2; ++mode)
+   {
+      const trecs::component_storage_enum_t storage = (mode == 0) ? \
+         trecs::PER_TYPE_POOLS : trecs::ARCHETYPE_CHUNKS;
+
+      trecs::Allocator allocator(256, storage);
+      allocator.registerComponent<sleepingTag_t>();
+      allocator.registerComponent<int>();
+
+      trecs::query_t sleeping_query = allocator.addArchetypeQuery<sleepingTag_t, int>();
+      trecs::query_t int_query = allocator.addArchetypeQuery<int>();
+
+      std::vector<trecs::uid_t> entities;
+      for (int i = 0; i < 20; ++i)
+      {
+         trecs::uid_t entity = allocator.addEntity();
+         entities.push_back(entity);
+         REQUIRE( allocator.addComponent(entity, i) );
+
+         if ((i % 2) == 0)
+         {
+            REQUIRE( allocator.addComponent(entity, sleepingTag_t()) );
+            REQUIRE( !allocator.addComponent(entity, sleepingTag_t()) );
+         }
+      }
+
+      REQUIRE( allocator.getQueryEntities(sleeping_query).size() == 10 );
+      REQUIRE( allocator.getQueryEntities(int_query).size() == 20 );
+      REQUIRE( allocator.hasComponent<sleepingTag_t>(entities[4]) );
+      REQUIRE( !allocator.hasComponent<sleepingTag_t>(entities[5]) );
+
+      sleepingTag_t tag;
+      REQUIRE( allocator.readComponent(entities[4], tag) );
+      REQUIRE( !allocator.readComponent(entities[5], tag) );
+
+      // Updating an existing tag doesn't change anything.
+      REQUIRE( allocator.updateComponent(entities[4], sleepingTag_t()) );
+      REQUIRE( allocator.getQueryEntities(sleeping_query).size() == 10 );
+
+      REQUIRE( allocator.updateComponent(entities[5], sleepingTag_t()) );
+      REQUIRE( allocator.getQueryEntities(sleeping_query).size() == 11 );
+
+      allocator.removeComponent<sleepingTag_t>(entities[4]);
+      allocator.removeEntity(entities[6]);
+
+      REQUIRE( !allocator.hasComponent<sleepingTag_t>(entities[4]) );
+      REQUIRE( allocator.getQueryEntities(sleeping_query).size() == 9 );
+      REQUIRE( allocator.getQueryEntities(int_query).size() == 19 );
+      REQUIRE( *allocator.getComponent<int>(entities[4]) == 4 );
+   }
+}
+
+TEST_CASE( "sort pools by query", "[Allocator]" )
+{
+   trecs::Allocator allocator(1024);
+   allocator.registerComponent<int>();
+   allocator.registerComponent<float>();
+   allocator.registerComponent<soaPoint_t>();
+   allocator.registerComponent<sleepingTag_t>();
+
+   trecs::query_t query = allocator.addArchetypeQuery<int, float, soaPoint_t, sleepingTag_t>();
+
+   // Components are added in different orders so that the pools disagree.
+   std::vector<trecs::uid_t> entities;
+   for (int i = 0; i < 300; ++i)
+   {
+      entities.push_back(allocator.addEntity());
+      allocator.addComponent(entities.back(), i);
+   }
+
+   for (int i = 299; i >= 0; --i)
+   {
+      if ((i % 3) == 0)
+      {
+         continue;
+      }
+
+      soaPoint_t point;
+      point.x = static_cast<float>(i);
+      point.y = 0.f;
+      allocator.addComponent(entities[i], static_cast<float>(i));
+      allocator.addComponent(entities[i], point);
+      allocator.addComponent(entities[i], sleepingTag_t());
+   }
+
+   for (int i = 0; i < 300; i += 5)
+   {
+      allocator.removeEntity(entities[i]);
+   }
+
+   const size_t num_sorted = allocator.sortByQuery(query);
+   REQUIRE( num_sorted == allocator.getQueryEntities(query).size() );
+
+   auto ints = allocator.getComponents<int>();
+   auto floats = allocator.getComponents<float>();
+   auto points = allocator.getSoaComponents<soaPoint_t>();
+
+   trecs::uid_t last_uid = -1;
+   for (size_t i = 0; i < num_sorted; ++i)
+   {
+      const trecs::uid_t uid = ints.uids()[i];
+      REQUIRE( uid > last_uid );
+      REQUIRE( floats.uids()[i] == uid );
+      REQUIRE( points.uids()[i] == uid );
+      REQUIRE( allocator.getQueryEntities(query)[i] == uid );
+
+      const int value = ints.page(i / ints.pageSize())[i % ints.pageSize()];
+      const float float_value = floats.page(i / floats.pageSize())[i % floats.pageSize()];
+      REQUIRE( float_value == static_cast<float>(value) );
+      REQUIRE( points.column(0)[i] == static_cast<float>(value) );
+
+      last_uid = uid;
+   }
+
+   // Sorting a single pool doesn't change which component belongs to which
+   // entity.
+   REQUIRE(
+      allocator.sortPool<int>(
+         [](const int a, const int b)
+         {
+            return a > b;
+         }
+      )
+   );
+
+   REQUIRE( !allocator.sortPool<sleepingTag_t>(
+      [](const sleepingTag_t &, const sleepingTag_t &)
+      {
+         return false;
+      }
+   ) );
+
+   for (const auto entity : allocator.getQueryEntities(query))
+   {
+      REQUIRE( static_cast<float>(*allocator.getComponent<int>(entity)) == *allocator.getComponent<float>(entity) );
+   }
+}
+
+TEST_CASE( "entity handles go stale when entities are removed", "[Allocator]" )
+{
+   trecs::Allocator allocator(16);
+   allocator.registerComponent<int>();
+
+   const trecs::uid_t node_a = allocator.addEntity();
+   const trecs::uid_t node_b = allocator.addEntity();
+   const trecs::uid_t edge = allocator.addEntity(node_a, node_b);
+
+   const trecs::entity_handle_t handle_a = allocator.getEntityHandle(node_a);
+   const trecs::entity_handle_t handle_edge = allocator.getEntityHandle(edge);
+
+   REQUIRE( allocator.entityHandleValid(handle_a) );
+   REQUIRE( allocator.getEntityUid(handle_a) == node_a );
+
+   allocator.removeEntity(node_a);
+
+   REQUIRE( !allocator.entityHandleValid(handle_a) );
+   REQUIRE( allocator.getEntityUid(handle_a) == -1 );
+   REQUIRE( allocator.entityHandleValid(handle_edge) );
+
+   // Fill the allocator so that the removed UID gets reused.
+   while (allocator.addEntity() >= 0) { }
+
+   REQUIRE( allocator.hasComponent<int>(node_a) == false );
+   REQUIRE( !allocator.entityHandleValid(handle_a) );
+   REQUIRE( allocator.entityHandleValid(allocator.getEntityHandle(node_a)) );
+   REQUIRE( allocator.getEntityHandle(-3) == trecs::error_entity_handle );
+}
+
+TEST_CASE( "spawn entities from prototype components", "[Allocator]" )
+{
+   for (int mode = 0; mode < 2; ++mode)
+   {
+      const trecs::component_storage_enum_t storage = (mode == 0) ? \
+         trecs::PER_TYPE_POOLS : trecs::ARCHETYPE_CHUNKS;
+
+      trecs::Allocator allocator(1024, storage);
+      allocator.registerComponent<complicatedType_t<0> >();
+      allocator.registerComponent<float>();
+      allocator.registerComponent<soaPoint_t>();
+      allocator.registerComponent<sleepingTag_t>();
+
+      trecs::query_t full_query = allocator.addArchetypeQuery<
+         complicatedType_t<0>, float, soaPoint_t, sleepingTag_t
+      >();
+      trecs::query_t float_query = allocator.addArchetypeQuery<float>();
+      trecs::query_t int_query = allocator.addArchetypeQuery<int>();
+
+      // An entity that was added the slow way doesn't get in the way.
+      trecs::uid_t lone_entity = allocator.addEntity();
+      REQUIRE( allocator.addComponent(lone_entity, 2.f) );
+
+      complicatedType_t<0> comp;
+      comp.int_field = 7;
+      comp.float_field = -1.5f;
+
+      soaPoint_t point;
+      point.x = 3.f;
+      point.y = 4.f;
+
+      std::vector<trecs::uid_t> entities = allocator.spawn(
+         500, comp, 9.f, point, sleepingTag_t()
+      );
+
+      REQUIRE( entities.size() == 500 );
+      REQUIRE( allocator.getEntities().size() == 501 );
+      REQUIRE( allocator.getQueryEntities(full_query).size() == 500 );
+      REQUIRE( allocator.getQueryEntities(float_query).size() == 501 );
+      REQUIRE( allocator.getQueryEntities(int_query).size() == 0 );
+
+      for (const auto entity : entities)
+      {
+         REQUIRE( entity != lone_entity );
+         REQUIRE( *allocator.getComponent<complicatedType_t<0> >(entity) == comp );
+         REQUIRE( *allocator.getComponent<float>(entity) == 9.f );
+         REQUIRE( allocator.hasComponent<sleepingTag_t>(entity) );
+
+         soaPoint_t read_point;
+         REQUIRE( allocator.readComponent(entity, read_point) );
+         REQUIRE( read_point.x == 3.f );
+         REQUIRE( read_point.y == 4.f );
+      }
+
+      // Spawned entities behave like any other entity.
+      allocator.removeComponent<float>(entities[10]);
+      allocator.removeEntity(entities[11]);
+      REQUIRE( allocator.getQueryEntities(full_query).size() == 498 );
+      REQUIRE( *allocator.getComponent<complicatedType_t<0> >(entities[10]) == comp );
+
+      if (storage == trecs::ARCHETYPE_CHUNKS)
+      {
+         // Chunks only hold object components.
+         trecs::query_t object_query = allocator.addArchetypeQuery<
+            complicatedType_t<0>, float
+         >();
+
+         size_t num_chunk_entities = 0;
+         for (auto chunk : allocator.getQueryChunks(object_query))
+         {
+            num_chunk_entities += chunk->size();
+         }
+
+         REQUIRE( num_chunk_entities == 498 );
+      }
+   }
+}
+
+TEST_CASE( "spawn entities from component spans", "[Allocator]" )
+{
+   for (int mode = 0; mode < 2; ++mode)
+   {
+      const trecs::component_storage_enum_t storage = (mode == 0) ? \
+         trecs::PER_TYPE_POOLS : trecs::ARCHETYPE_CHUNKS;
+
+      trecs::Allocator allocator(2048, storage);
+      allocator.registerComponent<int>();
+      allocator.registerComponent<soaPoint_t>();
+
+      trecs::query_t query = allocator.addArchetypeQuery<int, soaPoint_t>();
+
+      std::vector<int> ints;
+      std::vector<soaPoint_t> points;
+      for (int i = 0; i < 1500; ++i)
+      {
+         ints.push_back(i);
+
+         soaPoint_t point;
+         point.x = static_cast<float>(i);
+         point.y = static_cast<float>(-i);
+         points.push_back(point);
+      }
+
+      std::vector<trecs::uid_t> entities = allocator.spawn(
+         trecs::Span<const int>(ints.data(), ints.size()),
+         trecs::Span<const soaPoint_t>(points.data(), points.size())
+      );
+
+      REQUIRE( entities.size() == 1500 );
+      REQUIRE( allocator.getQueryEntities(query).size() == 1500 );
+
+      for (size_t i = 0; i < entities.size(); ++i)
+      {
+         REQUIRE( *allocator.getComponent<int>(entities[i]) == static_cast<int>(i) );
+
+         soaPoint_t point;
+         REQUIRE( allocator.readComponent(entities[i], point) );
+         REQUIRE( point.y == static_cast<float>(-static_cast<int>(i)) );
+      }
+
+      // Spans of different lengths are rejected.
+      REQUIRE(
+         allocator.spawn(
+            trecs::Span<const int>(ints.data(), 10),
+            trecs::Span<const soaPoint_t>(points.data(), 11)
+         ).empty()
+      );
+      REQUIRE( allocator.getEntities().size() == 1500 );
+   }
+}
+
+TEST_CASE( "spawning fails without adding entities", "[Allocator]" )
+{
+   trecs::Allocator allocator(64);
+   allocator.registerComponent<int>();
+
+   trecs::query_t query = allocator.addArchetypeQuery<int>();
+
+   // Unregistered component types.
+   REQUIRE( allocator.spawn(10, 1, 2.f).empty() );
+
+   // Repeated component types.
+   REQUIRE( allocator.spawn(10, 1, 2).empty() );
+
+   // Too many entities.
+   REQUIRE( allocator.spawn(65, 1).empty() );
+
+   REQUIRE( allocator.getEntities().size() == 0 );
+   REQUIRE( allocator.getQueryEntities(query).size() == 0 );
+
+   REQUIRE( allocator.spawn(64, 1).size() == 64 );
+   REQUIRE( allocator.spawn(1, 1).empty() );
+   REQUIRE( allocator.getQueryEntities(query).size() == 64 );
+}
+
+TEST_CASE( "remove batches of entities", "[Allocator]" )
+{
+   for (int mode = 0; mode < 2; ++mode)
+   {
+      const trecs::component_storage_enum_t storage = (mode == 0) ? \
+         trecs::PER_TYPE_POOLS : trecs::ARCHETYPE_CHUNKS;
+
+      trecs::Allocator allocator(1024, storage);
+      allocator.registerComponent<int>();
+      allocator.registerComponent<float>();
+      allocator.registerComponent<soaPoint_t>();
+      allocator.registerComponent<sleepingTag_t>();
+
+      trecs::query_t int_query = allocator.addArchetypeQuery<int>();
+      trecs::query_t float_query = allocator.addArchetypeQuery<float>();
+      trecs::query_t sleeping_query = allocator.addArchetypeQuery<sleepingTag_t>();
+
+      soaPoint_t point;
+      point.x = 1.f;
+      point.y = 2.f;
+
+      std::vector<trecs::uid_t> ints = allocator.spawn(100, 1, point);
+      std::vector<trecs::uid_t> floats = allocator.spawn(100, 2.f, sleepingTag_t());
+
+      const trecs::uid_t edge_a = allocator.addEntity(ints[0], floats[0]);
+      const trecs::uid_t edge_b = allocator.addEntity(ints[1], ints[2]);
+      const trecs::uid_t edge_c = allocator.addEntity(floats[1]);
+
+      // Every other entity of both archetypes, plus a repeat, an inactive
+      // UID, and an edge.
+      std::vector<trecs::uid_t> removed;
+      for (size_t i = 0; i < 100; i += 2)
+      {
+         removed.push_back(ints[i]);
+         removed.push_back(floats[i]);
+      }
+      removed.push_back(ints[0]);
+      removed.push_back(1000);
+      removed.push_back(edge_c);
+
+      allocator.removeEntities(
+         trecs::Span<const trecs::uid_t>(removed.data(), removed.size())
+      );
+
+      REQUIRE( allocator.getEntities().size() == 102 );
+      REQUIRE( allocator.getQueryEntities(int_query).size() == 50 );
+      REQUIRE( allocator.getQueryEntities(float_query).size() == 50 );
+      REQUIRE( allocator.getQueryEntities(sleeping_query).size() == 50 );
+      REQUIRE( allocator.getSoaComponents<soaPoint_t>().size() == 50 );
+      REQUIRE( !allocator.hasComponent<int>(ints[0]) );
+      REQUIRE( *allocator.getComponent<int>(ints[1]) == 1 );
+      REQUIRE( *allocator.getComponent<float>(floats[1]) == 2.f );
+
+      const trecs::edge_t edge_a_value = allocator.getEdge(edge_a);
+      REQUIRE( edge_a_value.nodeIdA == -1 );
+      REQUIRE( edge_a_value.nodeIdB == -1 );
+      REQUIRE( edge_a_value.flag == trecs::edge_flag_enum_t::NULL_EDGE );
+
+      const trecs::edge_t edge_b_value = allocator.getEdge(edge_b);
+      REQUIRE( edge_b_value.nodeIdA == ints[1] );
+      REQUIRE( edge_b_value.nodeIdB == -1 );
+      REQUIRE( edge_b_value.flag == trecs::edge_flag_enum_t::NODE_B_TERMINAL );
+
+      REQUIRE( allocator.getEdge(edge_c).edgeId == -1 );
+
+      // Removing a query's entities empties it without touching others.
+      allocator.removeEntities(float_query);
+
+      REQUIRE( allocator.getQueryEntities(float_query).size() == 0 );
+      REQUIRE( allocator.getQueryEntities(sleeping_query).size() == 0 );
+      REQUIRE( allocator.getQueryEntities(int_query).size() == 50 );
+      REQUIRE( allocator.getEntities().size() == 52 );
+
+      // Removed UIDs are handed out again.
+      REQUIRE( allocator.spawn(150, 3).size() == 150 );
+      REQUIRE( allocator.getQueryEntities(int_query).size() == 200 );
+   }
+}
+
+TEST_CASE( "allocators hold more than a million entities", "[Allocator]" )
+{
+   const size_t num_entities = (1 << 20) + 100;
+   trecs::Allocator allocator(1 << 21);
+   allocator.registerComponent<int>();
+
+   trecs::query_t query = allocator.addArchetypeQuery<int>();
+
+   std::vector<trecs::uid_t> entities = allocator.spawn(num_entities, 7);
+   REQUIRE( entities.size() == num_entities );
+   REQUIRE( allocator.getQueryEntities(query).size() == num_entities );
+
+   const trecs::uid_t last_entity = entities.back();
+   REQUIRE( last_entity >= (1 << 20) );
+   REQUIRE( *allocator.getComponent<int>(last_entity) == 7 );
+
+   allocator.removeEntity(last_entity);
+   REQUIRE( !allocator.hasComponent<int>(last_entity) );
+   REQUIRE( allocator.getQueryEntities(query).size() == num_entities - 1 );
+}
+
+TEST_CASE( "disabled entities are skipped without structural changes", "[Allocator]" )
+{
+   trecs::Allocator allocator(256);
+   allocator.registerComponent<int>();
+   allocator.registerComponent<float>();
+
+   trecs::query_t query = allocator.addArchetypeQuery<int, float>();
+
+   std::vector<trecs::uid_t> entities = allocator.spawn(100, 1, 2.f);
+   const trecs::Span<const trecs::uid_t> pool_uids = allocator.getComponents<int>().uids();
+   const std::vector<trecs::uid_t> pool_order(pool_uids.begin(), pool_uids.end());
+
+   for (size_t i = 0; i < entities.size(); i += 4)
+   {
+      REQUIRE( allocator.disableEntity(entities[i]) );
+   }
+
+   // Disabling doesn't touch query sets or pools.
+   REQUIRE( allocator.getQueryEntities(query).size() == 100 );
+   const trecs::Span<const trecs::uid_t> new_pool_uids = allocator.getComponents<int>().uids();
+   REQUIRE( std::vector<trecs::uid_t>(new_pool_uids.begin(), new_pool_uids.end()) == pool_order );
+   REQUIRE( allocator.hasComponent<float>(entities[0]) );
+   REQUIRE( *allocator.getComponent<int>(entities[0]) == 1 );
+
+   size_t num_visited = 0;
+   allocator.forEachQueryEntity(
+      query,
+      [&allocator, &num_visited](trecs::uid_t entity)
+      {
+         REQUIRE( allocator.entityEnabled(entity) );
+         ++num_visited;
+      }
+   );
+   REQUIRE( num_visited == 75 );
+
+   REQUIRE( allocator.enableEntity(entities[0]) );
+   num_visited = 0;
+   allocator.forEachQueryEntity(
+      query,
+      [&num_visited](trecs::uid_t)
+      {
+         ++num_visited;
+      }
+   );
+   REQUIRE( num_visited == 76 );
+
+   allocator.removeEntity(entities[4]);
+   REQUIRE( !allocator.enableEntity(entities[4]) );
+   REQUIRE( !allocator.entityEnabled(entities[4]) );
+}
+
+TEST_CASE( "entities are added from reserved UIDs", "[Allocator]" )
+{
+   trecs::Allocator allocator(64);
+   allocator.registerComponent<int>();
+
+   trecs::query_t query = allocator.addArchetypeQuery<int>();
+
+   trecs::UidReservation reservation = allocator.reserveEntities(16);
+   REQUIRE( reservation.remaining() == 16 );
+
+   std::vector<trecs::uid_t> taken;
+   for (int i = 0; i < 10; ++i)
+   {
+      taken.push_back(reservation.takeUid());
+   }
+
+   for (size_t i = 0; i < taken.size(); ++i)
+   {
+      REQUIRE( allocator.addReservedEntity(taken[i]) == taken[i] );
+      REQUIRE( allocator.addComponent(taken[i], static_cast<int>(i)) );
+   }
+
+   allocator.releaseReservation(reservation);
+
+   REQUIRE( allocator.getQueryEntities(query).size() == 10 );
+   REQUIRE( *allocator.getComponent<int>(taken[3]) == 3 );
+   REQUIRE( allocator.addReservedEntity(taken[3]) == -1 );
+
+   // Released UIDs are handed out again.
+   REQUIRE( allocator.spawn(54, 1).size() == 54 );
+   REQUIRE( allocator.addEntity() == -1 );
+}
+
+TEST_CASE( "typed query views visit enabled entities with their components", "[Allocator]" )
+{
+   const trecs::component_storage_enum_t modes[] = {
+      trecs::PER_TYPE_POOLS, trecs::ARCHETYPE_CHUNKS
+   };
+
+   for (const auto mode : modes)
+   {
+      trecs::Allocator allocator(256, mode);
+      allocator.registerComponent<int>();
+      allocator.registerComponent<float>();
+      allocator.registerComponent<complicatedType_t<0> >();
+
+      trecs::query_t query = allocator.addArchetypeQuery<int, float>();
+
+      std::vector<trecs::uid_t> entities;
+      for (int i = 0; i < 50; ++i)
+      {
+         entities.push_back(allocator.addEntity());
+         allocator.addComponent(entities.back(), i);
+         if ((i % 5) != 0)
+         {
+            allocator.addComponent(entities.back(), static_cast<float>(i));
+         }
+      }
+
+      allocator.disableEntity(entities[1]);
+
+      size_t num_visited = 0;
+      allocator.view<float, int>(query).each(
+         [&num_visited](trecs::uid_t, float & float_value, int & int_value)
+         {
+            REQUIRE( float_value == static_cast<float>(int_value) );
+            float_value *= 2.f;
+            ++num_visited;
+         }
+      );
+
+      REQUIRE( num_visited == 39 );
+      REQUIRE( *allocator.getComponent<float>(entities[2]) == 4.f );
+      REQUIRE( *allocator.getComponent<float>(entities[1]) == 1.f );
+
+      // Views follow the query order.
+      std::vector<trecs::uid_t> visited;
+      auto int_view = allocator.view<int>(query);
+      REQUIRE( int_view.size() == 40 );
+      int_view.each(
+         [&visited](trecs::uid_t entity, int &)
+         {
+            visited.push_back(entity);
+         }
+      );
+
+      const auto query_entities = allocator.getQueryEntities(query);
+      REQUIRE( visited.size() == 39 );
+      REQUIRE( query_entities[0] == entities[1] );
+      REQUIRE( visited.front() == query_entities[1] );
+
+      // Component types outside of the query's archetype give empty views.
+      REQUIRE( allocator.view<complicatedType_t<0> >(query).empty() );
+      REQUIRE( allocator.view<int>(trecs::error_query).empty() );
+   }
+}
+
+TEST_CASE( "queries with excluded and optional component types", "[Allocator]" )
+{
+   trecs::Allocator allocator(256);
+   allocator.registerComponent<int>();
+   allocator.registerComponent<float>();
+   allocator.registerComponent<sleepingTag_t>();
+
+   trecs::query_t awake_query = allocator.addArchetypeQuery<int, trecs::Without<sleepingTag_t> >();
+   trecs::query_t optional_query = allocator.addArchetypeQuery<int, trecs::Optional<float> >();
+
+   REQUIRE( awake_query != trecs::error_query );
+   REQUIRE( optional_query == allocator.addArchetypeQuery<int>() );
+
+   // Queries need a required type, and can't require and exclude a type.
+   REQUIRE( allocator.addArchetypeQuery<trecs::Without<int> >() == trecs::error_query );
+   REQUIRE( allocator.addArchetypeQuery<trecs::Optional<int> >() == trecs::error_query );
+   REQUIRE( allocator.addArchetypeQuery<int, trecs::Without<int> >() == trecs::error_query );
+
+   std::vector<trecs::uid_t> entities;
+   for (int i = 0; i < 30; ++i)
+   {
+      entities.push_back(allocator.addEntity());
+      allocator.addComponent(entities.back(), i);
+      if ((i % 2) == 0)
+      {
+         allocator.addComponent(entities.back(), static_cast<float>(i));
+      }
+      if ((i % 3) == 0)
+      {
+         allocator.addComponent(entities.back(), sleepingTag_t());
+      }
+   }
+
+   REQUIRE( allocator.getQueryEntities(awake_query).size() == 20 );
+   REQUIRE( allocator.getQueryEntities(optional_query).size() == 30 );
+
+   size_t num_visited = 0;
+   allocator.view<int>(awake_query).each(
+      [&num_visited](trecs::uid_t, int & value)
+      {
+         REQUIRE( (value % 3) != 0 );
+         ++num_visited;
+      }
+   );
+   REQUIRE( num_visited == 20 );
+
+   // Waking an entity up adds it to the query.
+   allocator.removeComponent<sleepingTag_t>(entities[3]);
+   REQUIRE( allocator.getQueryEntities(awake_query).size() == 21 );
+
+   size_t num_floats = 0;
+   allocator.view<int, trecs::Optional<float> >(optional_query).each(
+      [&num_floats](trecs::uid_t, int & value, float * float_value)
+      {
+         REQUIRE( (float_value != nullptr) == ((value % 2) == 0) );
+         if (float_value != nullptr)
+         {
+            REQUIRE( *float_value == static_cast<float>(value) );
+            ++num_floats;
+         }
+      }
+   );
+   REQUIRE( num_floats == 15 );
+}
+
+TEST_CASE( "queries registered after entities are added see them", "[Allocator]" )
+{
+   trecs::Allocator allocator(256);
+   allocator.registerComponent<int>();
+   allocator.registerComponent<float>();
+   allocator.registerComponent<sleepingTag_t>();
+
+   std::vector<trecs::uid_t> entities;
+   for (int i = 0; i < 30; ++i)
+   {
+      entities.push_back(allocator.addEntity());
+      allocator.addComponent(entities.back(), i);
+      if ((i % 3) == 0)
+      {
+         allocator.addComponent(entities.back(), sleepingTag_t());
+      }
+   }
+
+   std::vector<trecs::uid_t> spawned = allocator.spawn(10, 1.f, 2);
+   REQUIRE( spawned.size() == 10 );
+
+   allocator.removeEntity(entities[1]);
+
+   trecs::query_t int_query = allocator.addArchetypeQuery<int>();
+   trecs::query_t awake_query = allocator.addArchetypeQuery<int, trecs::Without<sleepingTag_t> >();
+   trecs::query_t float_query = allocator.addArchetypeQuery<float>();
+
+   REQUIRE( allocator.getQueryEntities(int_query).size() == 39 );
+   REQUIRE( allocator.getQueryEntities(awake_query).size() == 29 );
+   REQUIRE( allocator.getQueryEntities(float_query).size() == 10 );
+
+   size_t num_visited = 0;
+   allocator.view<const int>(awake_query).each(
+      [&num_visited](trecs::uid_t, const int & value)
+      {
+         REQUIRE( ((value == 2) || ((value % 3) != 0)) );
+         ++num_visited;
+      }
+   );
+   REQUIRE( num_visited == 29 );
+}
+
+TEST_CASE( "change ticks filter queries to added and written components", "[Allocator]" )
+{
+   trecs::Allocator allocator(256);
+   allocator.registerComponent<int>();
+   allocator.registerComponent<float>();
+
+   trecs::query_t changed_query = allocator.addArchetypeQuery<int, trecs::Changed<float> >();
+   trecs::query_t added_query = allocator.addArchetypeQuery<trecs::Added<int> >();
+   trecs::query_t int_query = allocator.addArchetypeQuery<int>();
+
+   // Change filters make distinct queries with the same matching entities.
+   REQUIRE( changed_query != allocator.addArchetypeQuery<int, float>() );
+   REQUIRE( added_query != int_query );
+
+   std::vector<trecs::uid_t> entities = allocator.spawn(10, 1, 2.f);
+   REQUIRE( allocator.getQueryEntities(changed_query).size() == 10 );
+
+   // A system that has never run sees everything.
+   size_t num_visited = 0;
+   allocator.forEachQueryEntity(
+      changed_query,
+      0,
+      [&num_visited](trecs::uid_t)
+      {
+         ++num_visited;
+      }
+   );
+   REQUIRE( num_visited == 10 );
+
+   const trecs::tick_t last_tick = allocator.advanceTick();
+   REQUIRE( allocator.changeTick() == last_tick );
+
+   num_visited = 0;
+   allocator.forEachQueryEntity(
+      changed_query,
+      last_tick,
+      [&num_visited](trecs::uid_t)
+      {
+         ++num_visited;
+      }
+   );
+   REQUIRE( num_visited == 0 );
+
+   // Updates, explicit marks, and mutable views record writes.
+   allocator.updateComponent(entities[2], 5.f);
+   REQUIRE( allocator.markChanged<float>(entities[7]) );
+   REQUIRE( !allocator.markChanged<float>(trecs::uid_t(200)) );
+   REQUIRE( allocator.componentChangedSince<float>(entities[2], last_tick) );
+   REQUIRE( !allocator.componentChangedSince<int>(entities[2], last_tick) );
+   REQUIRE( !allocator.componentAddedSince<float>(entities[2], last_tick) );
+
+   std::vector<trecs::uid_t> visited;
+   allocator.view<const int, float>(changed_query, last_tick).each(
+      [&visited](trecs::uid_t entity, const int &, float & value)
+      {
+         value += 1.f;
+         visited.push_back(entity);
+      }
+   );
+   REQUIRE( visited.size() == 2 );
+   REQUIRE( *allocator.getComponent<float>(entities[2]) == 6.f );
+
+   // Read-only view terms don't record writes.
+   allocator.view<const int>(int_query).each(
+      [](trecs::uid_t, const int &)
+      { }
+   );
+   REQUIRE( !allocator.componentChangedSince<int>(entities[0], last_tick) );
+
+   // A view that ignores change filters writes to every component it
+   // visits.
+   allocator.view<float>(changed_query).each(
+      [](trecs::uid_t, float &)
+      { }
+   );
+   REQUIRE( allocator.componentChangedSince<float>(entities[0], last_tick) );
+
+   // New components count as added and changed.
+   const trecs::tick_t next_tick = allocator.advanceTick();
+   const trecs::uid_t new_entity = allocator.addEntity();
+   allocator.addComponent(new_entity, 3);
+   allocator.addComponent(new_entity, 4.f);
+
+   visited.clear();
+   allocator.view<int>(added_query, next_tick).each(
+      [&visited](trecs::uid_t entity, int &)
+      {
+         visited.push_back(entity);
+      }
+   );
+   REQUIRE( visited.size() == 1 );
+   REQUIRE( visited[0] == new_entity );
+   REQUIRE( allocator.componentAddedSince<float>(new_entity, next_tick) );
+   REQUIRE( allocator.componentChangedSince<float>(new_entity, next_tick) );
+
+   // Removed components don't count as changed.
+   allocator.removeComponent<float>(new_entity);
+   REQUIRE( !allocator.componentChangedSince<float>(new_entity, next_tick) );
+}
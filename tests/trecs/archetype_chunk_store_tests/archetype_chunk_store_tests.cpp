@@ -0,0 +1,304 @@
+#include "archetype_chunk_store.hpp"
+
+#include "complicated_types.hpp"
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <vector>
+
+// Counts the number of live instances so that construction and destruction
+// of components in chunks can be verified.
+struct counted_t
+{
+   static int num_alive;
+
+   counted_t(void)
+      : value(0)
+   {
+      ++num_alive;
+   }
+
+   counted_t(const counted_t & other)
+      : value(other.value)
+   {
+      ++num_alive;
+   }
+
+   ~counted_t(void)
+   {
+      --num_alive;
+   }
+
+   counted_t & operator=(const counted_t & other) = default;
+
+   int value;
+};
+
+int counted_t::num_alive = 0;
+
+TEST_CASE( "add and retrieve components", "[ArchetypeChunkStore]" )
+{
+   trecs::ArchetypeChunkStore store;
+   store.registerComponent<complicatedType_t<0> >(0);
+   store.registerComponent<float>(1);
+
+   complicatedType_t<0> * ct = static_cast<complicatedType_t<0> *>(
+      store.addComponent(5, 0)
+   );
+   REQUIRE( ct != nullptr );
+   ct->int_field = 12;
+   ct->float_field = -3.f;
+
+   // Adding the same component twice fails.
+   REQUIRE( store.addComponent(5, 0) == nullptr );
+
+   // Adding an unregistered component fails.
+   REQUIRE( store.addComponent(5, 2) == nullptr );
+
+   float * f = static_cast<float *>(store.addComponent(5, 1));
+   REQUIRE( f != nullptr );
+   *f = 4.5f;
+
+   // The entity moved to a new table, and its old component came along.
+   ct = static_cast<complicatedType_t<0> *>(store.getComponent(5, 0));
+   REQUIRE( ct != nullptr );
+   REQUIRE( ct->int_field == 12 );
+   REQUIRE( ct->float_field == -3.f );
+   REQUIRE( *static_cast<float *>(store.getComponent(5, 1)) == 4.5f );
+
+   REQUIRE( store.numTables() == 2 );
+   REQUIRE( store.numComponents(0) == 1 );
+   REQUIRE( store.numComponents(1) == 1 );
+   REQUIRE( store.getComponent(6, 0) == nullptr );
+}
+
+TEST_CASE( "components of one archetype share chunks", "[ArchetypeChunkStore]" )
+{
+   trecs::ArchetypeChunkStore store(1024);
+   store.registerComponent<int>(0);
+   store.registerComponent<double>(3);
+
+   const int num_entities = 500;
+   for (int i = 0; i < num_entities; ++i)
+   {
+      *static_cast<int *>(store.addComponent(i, 0)) = i;
+      *static_cast<double *>(store.addComponent(i, 3)) = 2.0 * i;
+   }
+
+   trecs::DefaultArchetype query;
+   query.mergeSignature(0);
+   query.mergeSignature(3);
+
+   const auto chunks = store.getChunks(query);
+   REQUIRE( chunks.size() > 1 );
+
+   size_t num_rows = 0;
+   for (const auto chunk : chunks)
+   {
+      REQUIRE( chunk->size() <= chunk->capacity() );
+
+      const auto uids = chunk->uids();
+      const auto ints = chunk->getColumn<int>(0);
+      const auto doubles = chunk->getColumn<double>(3);
+
+      REQUIRE( ints.size() == uids.size() );
+      REQUIRE( doubles.size() == uids.size() );
+
+      // Columns are aligned for their component types.
+      REQUIRE( reinterpret_cast<size_t>(doubles.data()) % alignof(double) == 0 );
+
+      for (size_t i = 0; i < uids.size(); ++i)
+      {
+         REQUIRE( ints[i] == uids[i] );
+         REQUIRE( doubles[i] == 2.0 * uids[i] );
+      }
+
+      num_rows += chunk->size();
+   }
+
+   REQUIRE( num_rows == num_entities );
+
+   // A chunk doesn't have columns for components outside of its archetype.
+   REQUIRE( chunks[0]->getColumn<float>(7).empty() );
+}
+
+TEST_CASE( "removing components keeps tables packed", "[ArchetypeChunkStore]" )
+{
+   trecs::ArchetypeChunkStore store(512);
+   store.registerComponent<int>(0);
+   store.registerComponent<float>(1);
+
+   const int num_entities = 300;
+   for (int i = 0; i < num_entities; ++i)
+   {
+      *static_cast<int *>(store.addComponent(i, 0)) = i;
+      *static_cast<float *>(store.addComponent(i, 1)) = 0.5f * i;
+   }
+
+   for (int i = 0; i < num_entities; i += 3)
+   {
+      store.removeComponent(i, 1);
+   }
+
+   for (int i = 1; i < num_entities; i += 3)
+   {
+      store.removeComponents(i);
+   }
+
+   std::vector<trecs::uid_t> int_entities = store.getComponentEntities(0);
+   std::vector<trecs::uid_t> float_entities = store.getComponentEntities(1);
+
+   REQUIRE( int_entities.size() == 200 );
+   REQUIRE( float_entities.size() == 100 );
+
+   for (int i = 0; i < num_entities; ++i)
+   {
+      int * int_component = static_cast<int *>(store.getComponent(i, 0));
+      float * float_component = static_cast<float *>(store.getComponent(i, 1));
+
+      if ((i % 3) == 1)
+      {
+         REQUIRE( int_component == nullptr );
+         REQUIRE( float_component == nullptr );
+      }
+      else if ((i % 3) == 0)
+      {
+         REQUIRE( *int_component == i );
+         REQUIRE( float_component == nullptr );
+      }
+      else
+      {
+         REQUIRE( *int_component == i );
+         REQUIRE( *float_component == 0.5f * i );
+      }
+   }
+
+   // All chunks except the last one in every table are full.
+   trecs::DefaultArchetype query;
+   query.mergeSignature(0);
+   const auto chunks = store.getChunks(query);
+
+   size_t num_rows = 0;
+   for (const auto chunk : chunks)
+   {
+      REQUIRE( chunk->size() > 0 );
+      num_rows += chunk->size();
+   }
+
+   REQUIRE( num_rows == 200 );
+}
+
+TEST_CASE( "components are destroyed when removed", "[ArchetypeChunkStore]" )
+{
+   counted_t::num_alive = 0;
+
+   {
+      trecs::ArchetypeChunkStore store;
+      store.registerComponent<counted_t>(0);
+      store.registerComponent<int>(1);
+
+      for (int i = 0; i < 64; ++i)
+      {
+         store.addComponent(i, 0);
+      }
+
+      REQUIRE( counted_t::num_alive == 64 );
+
+      // Moving entities between tables doesn't leak components.
+      for (int i = 0; i < 32; ++i)
+      {
+         store.addComponent(i, 1);
+      }
+
+      REQUIRE( counted_t::num_alive == 64 );
+
+      for (int i = 0; i < 16; ++i)
+      {
+         store.removeComponents(i);
+      }
+
+      REQUIRE( counted_t::num_alive == 48 );
+
+      store.removeComponent(20, 0);
+
+      REQUIRE( counted_t::num_alive == 47 );
+   }
+
+   REQUIRE( counted_t::num_alive == 0 );
+}
+
+TEST_CASE( "oversized components get one row per chunk", "[ArchetypeChunkStore]" )
+{
+   trecs::ArchetypeChunkStore store(64);
+   store.registerComponent<bigType_t>(0);
+
+   for (int i = 0; i < 4; ++i)
+   {
+      bigType_t * big = static_cast<bigType_t *>(store.addComponent(i, 0));
+      REQUIRE( big != nullptr );
+      big->int_field = i;
+   }
+
+   trecs::DefaultArchetype query;
+   query.mergeSignature(0);
+   const auto chunks = store.getChunks(query);
+
+   REQUIRE( chunks.size() == 4 );
+
+   for (int i = 0; i < 4; ++i)
+   {
+      REQUIRE( static_cast<bigType_t *>(store.getComponent(i, 0))->int_field == i );
+   }
+}
+
+TEST_CASE( "clear chunk store", "[ArchetypeChunkStore]" )
+{
+   trecs::ArchetypeChunkStore store;
+   store.registerComponent<int>(0);
+
+   for (int i = 0; i < 10; ++i)
+   {
+      store.addComponent(i, 0);
+   }
+
+   store.clear();
+
+   REQUIRE( store.numComponents(0) == 0 );
+   REQUIRE( store.getComponent(3, 0) == nullptr );
+   REQUIRE( store.addComponent(3, 0) != nullptr );
+}
+
+TEST_CASE( "chunks with excluded components are skipped", "[ArchetypeChunkStore]" )
+{
+   trecs::ArchetypeChunkStore store(1024);
+   store.registerComponent<int>(0);
+   store.registerComponent<float>(1);
+
+   for (int i = 0; i < 40; ++i)
+   {
+      *static_cast<int *>(store.addComponent(i, 0)) = i;
+      if ((i % 4) == 0)
+      {
+         store.addComponent(i, 1);
+      }
+   }
+
+   trecs::DefaultArchetype query;
+   query.mergeSignature(0);
+
+   trecs::DefaultArchetype excluded;
+   excluded.mergeSignature(1);
+
+   size_t num_rows = 0;
+   for (const auto chunk : store.getChunks(query, excluded))
+   {
+      REQUIRE( chunk->getColumn<float>(1).empty() );
+      num_rows += chunk->size();
+   }
+
+   REQUIRE( num_rows == 30 );
+   REQUIRE( store.getChunks(query).size() > store.getChunks(query, excluded).size() );
+}
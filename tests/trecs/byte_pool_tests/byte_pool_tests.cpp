@@ -425,3 +425,39 @@ TEST_CASE( "zero-out deleted bytes", "[BytePool]" )
       REQUIRE( weird_copy.bytes[i] == 0 );
    }
 }
+
+TEST_CASE( "assigned pool accepts new components after copied components", "[BytePool]" )
+{
+   trecs::BytePool<complicatedType_t<1> > alloc(50, 16);
+
+   std::vector<trecs::uid_t> uids;
+   for (int i = 0; i < 20; ++i)
+   {
+      uids.push_back(alloc.addComponent(complicatedType_t<1>{i, 2.f * i}));
+   }
+
+   alloc.removeComponent(uids[7]);
+
+   trecs::BytePool<complicatedType_t<1> > alloc_b(50, 16);
+   alloc_b = alloc;
+
+   REQUIRE( alloc_b.size() == 19 );
+   REQUIRE( alloc_b.getUids().size() == 19 );
+
+   // New components go after the copied components instead of on top of
+   // them.
+   trecs::uid_t new_uid = alloc_b.addComponent(complicatedType_t<1>{100, 1.f});
+   REQUIRE( new_uid >= 0 );
+   REQUIRE( alloc_b.getComponent(new_uid).int_field == 100 );
+
+   for (int i = 0; i < 20; ++i)
+   {
+      if (i == 7)
+      {
+         continue;
+      }
+
+      REQUIRE( alloc_b.getComponent(uids[i]).int_field == i );
+      REQUIRE( alloc_b.getComponent(uids[i]).float_field == 2.f * i );
+   }
+}
@@ -1727,3 +1727,105 @@ TEST_CASE( "clear partially filled component manager", "[ComponentManager]" )
    REQUIRE( cman.getNumComponents<int>() == 0);
    REQUIRE( cman.getNumComponents<complicatedType_t<26> >() == 0);
 }
+
+TEST_CASE( "dense view of a component array matches UID lookups", "[ComponentManager]" )
+{
+   trecs::ComponentManager cman(64);
+   cman.registerComponent<complicatedType_t<3> >();
+
+   for (int i = 0; i < 40; ++i)
+   {
+      complicatedType_t<3> temp_ct;
+      temp_ct.int_field = 3 * i;
+      temp_ct.float_field = -1.5f * i;
+      cman.addComponent(i, temp_ct);
+   }
+
+   for (int i = 0; i < 40; i += 3)
+   {
+      cman.removeComponent<complicatedType_t<3> >(i);
+   }
+
+   auto cts = cman.getComponents<complicatedType_t<3> >();
+   const auto uids = cts.uids();
+
+   REQUIRE( uids.size() == cts.size() );
+   REQUIRE( cts.size() == cman.getNumComponents<complicatedType_t<3> >() );
+
+   // The paged dense data and the dense UIDs are parallel arrays.
+   size_t num_paged = 0;
+   for (size_t p = 0; p < cts.numPages(); ++p)
+   {
+      auto page = cts.page(p);
+      for (size_t i = 0; i < page.size(); ++i)
+      {
+         const trecs::uid_t uid = uids[p * cts.pageSize() + i];
+         REQUIRE( &(page[i]) == cts[uid] );
+         REQUIRE( page[i].int_field == 3 * uid );
+      }
+
+      num_paged += page.size();
+   }
+
+   REQUIRE( num_paged == cts.size() );
+
+   // Iteration visits every (uid, component) pair exactly once and yields
+   // mutable references.
+   size_t num_visited = 0;
+   for (auto entry : cts)
+   {
+      REQUIRE( entry.component.int_field == 3 * entry.uid );
+      entry.component.float_field = 2.f;
+      ++num_visited;
+   }
+
+   REQUIRE( num_visited == cts.size() );
+
+   for (const auto uid : uids)
+   {
+      REQUIRE( cman.getComponent<complicatedType_t<3> >(uid)->float_field == 2.f );
+   }
+}
+
+TEST_CASE( "dense view of an empty component array wrapper", "[ComponentManager]" )
+{
+   trecs::ComponentArrayWrapper<int> ints;
+
+   REQUIRE( ints.size() == 0 );
+   REQUIRE( ints.numPages() == 0 );
+   REQUIRE( ints.page(0).empty() );
+   REQUIRE( ints.uids().empty() );
+   REQUIRE( !(ints.begin() != ints.end()) );
+}
+
+struct sleepingTag_t
+{ };
+
+TEST_CASE( "tag components don't allocate storage", "[ComponentManager]" )
+{
+   trecs::ArenaMemoryResource arena(1 << 20);
+
+   {
+      trecs::ComponentManager components(1024, trecs::PER_TYPE_POOLS, &arena);
+      components.registerComponent<sleepingTag_t>();
+
+      REQUIRE( components.getNumSignatures() == 1 );
+      REQUIRE( components.getSignature<sleepingTag_t>() != trecs::error_signature );
+      REQUIRE( arena.bytesUsed() == 0 );
+
+      for (int i = 0; i < 100; ++i)
+      {
+         REQUIRE( components.addComponent(i, sleepingTag_t()) == i );
+      }
+
+      components.removeComponent<sleepingTag_t>(3);
+      components.removeComponents(4);
+
+      REQUIRE( arena.bytesUsed() == 0 );
+
+      // Tags aren't stored, so they can't be assigned.
+      REQUIRE( !components.assignComponent<sleepingTag_t>(5, sleepingTag_t()) );
+   }
+
+   arena.release();
+}
@@ -861,3 +861,42 @@ TEST_CASE( "clear full ECB", "[EntityComponentBuffer]" )
    REQUIRE( ecb.getComponentEntities<int>().size() == 0 );
    REQUIRE( ecb.getComponentEntities<complicatedType_t<0> >().size() == 0 );
 }
+
+struct dirtyTag_t
+{ };
+
+TEST_CASE( "ECB tracks tag components", "[EntityComponentBuffer]" )
+{
+   trecs::EntityComponentBuffer ecb(32);
+   ecb.registerComponents<dirtyTag_t, complicatedType_t<0> >();
+
+   for (int i = 0; i < 10; ++i)
+   {
+      trecs::uid_t entity = ecb.addEntity();
+      if ((i % 3) == 0)
+      {
+         REQUIRE( ecb.updateComponent(entity, dirtyTag_t()) );
+         REQUIRE( ecb.updateComponent(entity, dirtyTag_t()) );
+      }
+      REQUIRE( ecb.updateComponent(entity, complicatedType_t<0>()) );
+   }
+
+   std::vector<trecs::uid_t> tagged = ecb.getComponentEntities<dirtyTag_t>();
+   REQUIRE( tagged.size() == 4 );
+   for (const auto entity : tagged)
+   {
+      REQUIRE( (entity % 3) == 0 );
+   }
+
+   REQUIRE( ecb.hasComponent<dirtyTag_t>(3) );
+   REQUIRE( !ecb.hasComponent<dirtyTag_t>(4) );
+   REQUIRE( ecb.hasComponent<complicatedType_t<0> >(4) );
+   REQUIRE( !ecb.hasComponent<dirtyTag_t>(20) );
+
+   // Tags survive being moved into another ECB.
+   trecs::EntityComponentBuffer ecb_b(std::move(ecb));
+   REQUIRE( ecb_b.getComponentEntities<dirtyTag_t>().size() == 4 );
+
+   ecb_b.clear();
+   REQUIRE( ecb_b.getComponentEntities<dirtyTag_t>().empty() );
+}
@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <set>
+#include <thread>
 #include <vector>
 
 TEST_CASE( "entity manager respects max size", "[EntityManager]" )
@@ -264,3 +265,354 @@ TEST_CASE( "assignment operator with un-archetyped entities", "[EntityManager]"
       REQUIRE( em2.getArchetype(entity).empty() );
    }
 }
+
+TEST_CASE( "liveness stays consistent through removals", "[EntityManager]" )
+{
+   size_t max_size = 64;
+   trecs::EntityManager em(max_size);
+
+   for (size_t i = 0; i < max_size; ++i)
+   {
+      em.addEntity();
+   }
+
+   REQUIRE( !em.entityActive(-1) );
+   REQUIRE( !em.entityActive(static_cast<trecs::uid_t>(max_size)) );
+   REQUIRE( !em.entityActive(100000) );
+
+   // Remove every third entity, including the last one.
+   for (size_t i = 0; i < max_size; i += 3)
+   {
+      em.removeEntity(i);
+   }
+   em.removeEntity(max_size - 1);
+
+   std::set<trecs::uid_t> remaining(em.getUids().begin(), em.getUids().end());
+   REQUIRE( remaining.size() == em.size() );
+
+   for (size_t i = 0; i < max_size; ++i)
+   {
+      const bool expected = ((i % 3) != 0) && (i != max_size - 1);
+      REQUIRE( em.entityActive(i) == expected );
+      REQUIRE( (remaining.count(i) == 1) == expected );
+   }
+
+   // Removed UIDs can be reused and become active again.
+   const trecs::uid_t new_entity = em.addEntity();
+   REQUIRE( new_entity >= 0 );
+   REQUIRE( em.entityActive(new_entity) );
+   REQUIRE( em.setArchetype(new_entity, trecs::DefaultArchetype()) );
+
+   em.clear();
+   REQUIRE( em.size() == 0 );
+   REQUIRE( !em.entityActive(new_entity) );
+   REQUIRE( !em.entityActive(1) );
+}
+
+TEST_CASE( "stale handles are detected", "[EntityManager]" )
+{
+   trecs::EntityManager em(8);
+
+   const trecs::uid_t entity = em.addEntity();
+   const trecs::entity_handle_t handle = em.getHandle(entity);
+
+   REQUIRE( handle.uid() == entity );
+   REQUIRE( em.handleValid(handle) );
+   REQUIRE( !em.handleValid(trecs::error_entity_handle) );
+   REQUIRE( em.getHandle(5) == trecs::error_entity_handle );
+
+   em.removeEntity(entity);
+   REQUIRE( !em.handleValid(handle) );
+
+   // Reuse the same UID by cycling through every free UID.
+   trecs::uid_t reused = -1;
+   for (int i = 0; i < 8; ++i)
+   {
+      const trecs::uid_t new_entity = em.addEntity();
+      if (new_entity == entity)
+      {
+         reused = new_entity;
+      }
+   }
+
+   REQUIRE( reused == entity );
+   REQUIRE( !em.handleValid(handle) );
+
+   const trecs::entity_handle_t new_handle = em.getHandle(reused);
+   REQUIRE( new_handle != handle );
+   REQUIRE( new_handle.uid() == handle.uid() );
+   REQUIRE( new_handle.generation() != handle.generation() );
+   REQUIRE( em.handleValid(new_handle) );
+
+   trecs::EntityManager em_copy(8);
+   em_copy = em;
+   REQUIRE( em_copy.handleValid(new_handle) );
+
+   em.clear();
+   REQUIRE( !em.handleValid(new_handle) );
+}
+
+TEST_CASE( "freed UIDs are reused most recent first", "[EntityManager]" )
+{
+   trecs::EntityManager em(10);
+
+   for (int i = 0; i < 6; ++i)
+   {
+      REQUIRE( em.addEntity() == i );
+   }
+
+   em.removeEntity(1);
+   em.removeEntity(4);
+   em.removeEntity(2);
+
+   REQUIRE( em.addEntity() == 2 );
+   REQUIRE( em.addEntity() == 4 );
+   REQUIRE( em.addEntity() == 1 );
+
+   // With no freed UIDs left, never-used UIDs are handed out in order.
+   for (int i = 6; i < 10; ++i)
+   {
+      REQUIRE( em.addEntity() == i );
+   }
+
+   REQUIRE( em.addEntity() == -1 );
+   REQUIRE( em.size() == 10 );
+
+   em.clear();
+   REQUIRE( em.addEntity() == 0 );
+}
+
+TEST_CASE( "legacy UID order hands out every UID before reusing", "[EntityManager]" )
+{
+   trecs::EntityManager em(6, trecs::LEGACY_UID_ORDER);
+
+   for (int i = 0; i < 3; ++i)
+   {
+      REQUIRE( em.addEntity() == i );
+   }
+
+   em.removeEntity(1);
+   em.removeEntity(0);
+
+   REQUIRE( em.addEntity() == 3 );
+   REQUIRE( em.addEntity() == 4 );
+   REQUIRE( em.addEntity() == 5 );
+
+   // Freed UIDs come back first-in first-out.
+   REQUIRE( em.addEntity() == 1 );
+   REQUIRE( em.addEntity() == 0 );
+   REQUIRE( em.addEntity() == -1 );
+
+   trecs::EntityManager em_copy(6);
+   em_copy = em;
+   em_copy.removeEntity(4);
+   em_copy.removeEntity(2);
+   REQUIRE( em_copy.addEntity() == 4 );
+}
+
+TEST_CASE( "per-UID storage grows with the UIDs handed out", "[EntityManager]" )
+{
+   // A huge maximum doesn't cost anything up front.
+   trecs::EntityManager em(1 << 19);
+
+   REQUIRE( em.size() == 0 );
+   REQUIRE( !em.entityActive(1000) );
+   REQUIRE( em.getArchetype(1000).empty() );
+
+   const trecs::uid_t entity = em.addEntity();
+   REQUIRE( entity == 0 );
+   REQUIRE( em.entityActive(entity) );
+   REQUIRE( !em.entityActive(1) );
+}
+
+TEST_CASE( "more than a million entities are supported", "[EntityManager]" )
+{
+   const size_t num_entities = (1 << 20) + 1000;
+   trecs::EntityManager em(1 << 22);
+
+   for (size_t i = 0; i < num_entities; ++i)
+   {
+      REQUIRE( em.addEntity() == static_cast<trecs::uid_t>(i) );
+   }
+
+   REQUIRE( em.size() == num_entities );
+   REQUIRE( em.numAvailable() == (1 << 22) - num_entities );
+
+   const trecs::uid_t last_entity = num_entities - 1;
+   trecs::DefaultArchetype arch;
+   arch.mergeSignature(5);
+   REQUIRE( em.setArchetype(last_entity, arch) );
+   REQUIRE( em.getArchetype(last_entity) == arch );
+
+   const trecs::entity_handle_t handle = em.getHandle(last_entity);
+   REQUIRE( em.handleValid(handle) );
+
+   em.removeEntity(last_entity);
+   REQUIRE( !em.entityActive(last_entity) );
+   REQUIRE( !em.handleValid(handle) );
+   REQUIRE( em.getArchetype(last_entity).empty() );
+   REQUIRE( em.addEntity() == last_entity );
+
+   // UIDs far beyond the high-water mark read as inactive without
+   // allocating anything.
+   REQUIRE( !em.entityActive(3000000000ll) );
+   REQUIRE( em.getArchetype(3000000000ll).empty() );
+}
+
+TEST_CASE( "entity UIDs are capped by the width of entity handles", "[EntityManager]" )
+{
+   trecs::EntityManager em(static_cast<trecs::uid_t>(1) << 40);
+
+   REQUIRE( em.numAvailable() == 0xffffffffu - 1 );
+   REQUIRE( em.addEntity() == 0 );
+}
+
+TEST_CASE( "entities can be disabled and enabled", "[EntityManager]" )
+{
+   trecs::EntityManager em(16);
+
+   const trecs::uid_t entity = em.addEntity();
+   trecs::DefaultArchetype arch;
+   arch.mergeSignature(3);
+   em.setArchetype(entity, arch);
+
+   REQUIRE( em.entityEnabled(entity) );
+
+   REQUIRE( em.numDisabled() == 0 );
+
+   REQUIRE( em.setEnabled(entity, false) );
+   REQUIRE( em.entityActive(entity) );
+   REQUIRE( !em.entityEnabled(entity) );
+   REQUIRE( em.getArchetype(entity) == arch );
+
+   // Disabling twice only counts once.
+   REQUIRE( em.setEnabled(entity, false) );
+   REQUIRE( em.numDisabled() == 1 );
+
+   REQUIRE( em.setEnabled(entity, true) );
+   REQUIRE( em.entityEnabled(entity) );
+   REQUIRE( em.numDisabled() == 0 );
+
+   // Removed and reused UIDs start out enabled.
+   em.setEnabled(entity, false);
+   em.removeEntity(entity);
+   REQUIRE( em.numDisabled() == 0 );
+   REQUIRE( !em.entityEnabled(entity) );
+   REQUIRE( !em.setEnabled(entity, true) );
+   REQUIRE( em.addEntity() == entity );
+   REQUIRE( em.entityEnabled(entity) );
+
+   REQUIRE( !em.entityEnabled(10) );
+   REQUIRE( !em.entityEnabled(-1) );
+}
+
+TEST_CASE( "reserved UIDs are taken without touching the manager", "[EntityManager]" )
+{
+   trecs::EntityManager em(100);
+
+   const trecs::uid_t first_entity = em.addEntity();
+
+   trecs::UidReservation reservation_a = em.reserveUids(10);
+   trecs::UidReservation reservation_b = em.reserveUids(20);
+
+   REQUIRE( reservation_a.remaining() == 10 );
+   REQUIRE( reservation_b.nextUid() == reservation_a.endUid() );
+   REQUIRE( em.numAvailable() == 100 - 31 );
+
+   // Reserved UIDs aren't handed out by addEntity.
+   const trecs::uid_t other_entity = em.addEntity();
+   REQUIRE( other_entity >= reservation_b.endUid() );
+
+   std::vector<trecs::uid_t> taken;
+   for (int i = 0; i < 4; ++i)
+   {
+      taken.push_back(reservation_a.takeUid());
+   }
+
+   REQUIRE( reservation_a.remaining() == 6 );
+   REQUIRE( !em.entityActive(taken[0]) );
+
+   REQUIRE( em.addReservedEntity(taken[0]) == taken[0] );
+   REQUIRE( em.addReservedEntity(taken[1]) == taken[1] );
+   REQUIRE( em.entityActive(taken[0]) );
+   REQUIRE( em.entityEnabled(taken[1]) );
+
+   // UIDs can only be added once, and only if they were reserved.
+   REQUIRE( em.addReservedEntity(taken[0]) == -1 );
+   REQUIRE( em.addReservedEntity(first_entity) == -1 );
+   REQUIRE( em.addReservedEntity(99) == -1 );
+
+   em.releaseUid(taken[2]);
+   em.releaseReservation(reservation_a);
+   REQUIRE( reservation_a.empty() );
+   REQUIRE( reservation_a.takeUid() == -1 );
+   REQUIRE( em.addReservedEntity(taken[2]) == -1 );
+
+   // 'taken[3]' is still reserved, everything else from reservation A is
+   // free again.
+   REQUIRE( em.numAvailable() == 100 - 31 - 1 + 7 );
+   REQUIRE( em.addReservedEntity(taken[3]) == taken[3] );
+
+   // Reservations are capped by the remaining never-used UIDs.
+   trecs::UidReservation big_reservation = em.reserveUids(1000);
+   REQUIRE( big_reservation.remaining() == static_cast<size_t>(100 - big_reservation.nextUid()) );
+
+   // Clearing the manager invalidates reservations.
+   em.clear();
+   REQUIRE( em.addReservedEntity(reservation_b.takeUid()) == -1 );
+   REQUIRE( em.numAvailable() == 100 );
+}
+
+TEST_CASE( "reservations are consumed on worker threads", "[EntityManager]" )
+{
+   const size_t num_threads = 4;
+   const size_t uids_per_thread = 5000;
+
+   trecs::EntityManager em(100000);
+
+   std::vector<trecs::UidReservation> reservations;
+   for (size_t i = 0; i < num_threads; ++i)
+   {
+      reservations.push_back(em.reserveUids(uids_per_thread));
+   }
+
+   std::vector<std::vector<trecs::uid_t> > taken(num_threads);
+   std::vector<std::thread> threads;
+   for (size_t i = 0; i < num_threads; ++i)
+   {
+      threads.push_back(
+         std::thread(
+            [&reservations, &taken, i]()
+            {
+               // Every other thread leaves some UIDs behind.
+               const size_t num_to_take = uids_per_thread - (i % 2) * 100;
+               for (size_t j = 0; j < num_to_take; ++j)
+               {
+                  taken[i].push_back(reservations[i].takeUid());
+               }
+            }
+         )
+      );
+   }
+
+   for (auto & thread : threads)
+   {
+      thread.join();
+   }
+
+   std::set<trecs::uid_t> unique_uids;
+   for (size_t i = 0; i < num_threads; ++i)
+   {
+      for (const auto uid : taken[i])
+      {
+         REQUIRE( em.addReservedEntity(uid) == uid );
+         unique_uids.insert(uid);
+      }
+
+      em.releaseReservation(reservations[i]);
+   }
+
+   REQUIRE( unique_uids.size() == em.size() );
+   REQUIRE( em.size() == num_threads * uids_per_thread - 200 );
+   REQUIRE( em.numAvailable() == 100000 - em.size() );
+}
@@ -566,3 +566,68 @@ TEST_CASE( "zero-out deleted bytes", "[ExternalUidBytePool]" )
       REQUIRE( weird_copy->bytes[i] == 0 );
    }
 }
+
+TEST_CASE( "assigned pool accepts new components after copied components", "[ExternalUidBytePool]" )
+{
+   size_t max_size = 50;
+   trecs::ExternalUidBytePool<complicatedType_t<1> > alloc(max_size, 16);
+
+   for (int i = 0; i < 20; ++i)
+   {
+      alloc.addComponent(i, complicatedType_t<1>{i, 2.f * i});
+   }
+
+   alloc.removeComponent(4);
+   alloc.removeComponent(11);
+
+   trecs::ExternalUidBytePool<complicatedType_t<1> > alloc_b(max_size, 16);
+   alloc_b = alloc;
+
+   REQUIRE( alloc_b.size() == 18 );
+   REQUIRE( alloc_b.sizeBytes() == alloc.sizeBytes() );
+
+   // New components go after the copied components instead of on top of
+   // them.
+   REQUIRE( alloc_b.addComponent(100, complicatedType_t<1>{100, 1.f}) == 100 );
+
+   for (int i = 0; i < 20; ++i)
+   {
+      if (i == 4 || i == 11)
+      {
+         REQUIRE( alloc_b.getComponent(i) == nullptr );
+         continue;
+      }
+
+      REQUIRE( alloc_b.getComponent(i)->int_field == i );
+      REQUIRE( alloc_b.getComponent(i)->float_field == 2.f * i );
+   }
+
+   REQUIRE( alloc_b.getComponent(100)->int_field == 100 );
+}
+
+TEST_CASE( "clear zeroes the bytes of active components", "[ExternalUidBytePool]" )
+{
+   trecs::ExternalUidBytePool<byteChecker_t> pooler(10, 32);
+
+   byteChecker_t temp;
+   temp.is_dirty = true;
+   temp.values[0] = 1.f;
+   temp.values[1] = 2.f;
+   temp.values[2] = 3.f;
+
+   pooler.addComponent(0, temp);
+   pooler.addComponent(1, temp);
+
+   byteChecker_t * first = pooler.getComponent(0);
+   byteChecker_t * second = pooler.getComponent(1);
+
+   pooler.clear();
+
+   REQUIRE( pooler.size() == 0 );
+
+   for (int i = 0; i < 12; ++i)
+   {
+      REQUIRE( first->bytes[i] == 0 );
+      REQUIRE( second->bytes[i] == 0 );
+   }
+}
@@ -605,3 +605,328 @@ TEST_CASE( "add non-empty ECB as a component and add components to the ECB", "[E
    REQUIRE( *ecb->getComponent<float>(new_ecb_entity) == 4.123f );
    REQUIRE( *ecb->getComponent<complicatedType_t<73> >(new_ecb_entity) == complicatedType_t<73>{123, -456.789f} );
 }
+
+TEST_CASE( "swap-remove keeps sparse UIDs mapped to the right components", "[ExternalUidObjectPool]" )
+{
+   size_t max_size = 64;
+   trecs::ExternalUidObjectPool<complicatedType_t<0> > pool(max_size);
+
+   // Use UIDs that are spread far apart so that several sparse pages are
+   // needed.
+   std::vector<trecs::uid_t> uids;
+   for (unsigned int i = 0; i < max_size; ++i)
+   {
+      uids.push_back(static_cast<trecs::uid_t>(i) * 100003);
+      complicatedType_t<0> component;
+      component.int_field = static_cast<int>(i);
+      component.float_field = 0.5f * static_cast<float>(i);
+      REQUIRE( pool.addComponent(uids.back(), component) == uids.back() );
+   }
+
+   REQUIRE( pool.addComponent(uids[3], complicatedType_t<0>()) == -1 );
+
+   // Remove every other component from the front of the dense array so that
+   // the last component is moved each time.
+   for (unsigned int i = 0; i < max_size; i += 2)
+   {
+      pool.removeComponent(uids[i]);
+      REQUIRE( pool.getComponent(uids[i]) == nullptr );
+   }
+
+   REQUIRE( pool.size() == max_size / 2 );
+   REQUIRE( pool.getUids().size() == max_size / 2 );
+
+   for (unsigned int i = 1; i < max_size; i += 2)
+   {
+      REQUIRE( pool.getComponent(uids[i]) != nullptr );
+      REQUIRE( pool.getComponent(uids[i])->int_field == static_cast<int>(i) );
+   }
+
+   // The dense UID array and the dense components stay in lockstep.
+   for (const auto uid : pool.getUids())
+   {
+      REQUIRE( pool.getComponent(uid)->int_field == static_cast<int>(uid / 100003) );
+   }
+
+   REQUIRE( pool.addComponent(-4, complicatedType_t<0>()) == -1 );
+}
+
+TEST_CASE( "pool pages are allocated on demand", "[ExternalUidObjectPool]" )
+{
+   const unsigned int max_size = 20000;
+   trecs::ExternalUidObjectPool<complicatedType_t<0> > pool(max_size);
+
+   // No memory is allocated for components until components are added.
+   REQUIRE( pool.numAllocatedPages() == 0 );
+   REQUIRE( pool.numPages() == 0 );
+   REQUIRE( pool.capacity() == max_size );
+
+   const size_t page_size = pool.pageSize();
+   REQUIRE( page_size > 1 );
+   REQUIRE( page_size < max_size );
+
+   pool.addComponent(7, complicatedType_t<0>());
+   REQUIRE( pool.numAllocatedPages() == 1 );
+
+   complicatedType_t<0> * first = pool.getComponent(7);
+   first->int_field = 99;
+
+   // Growing the pool doesn't move components that are already in it.
+   for (unsigned int i = 1; i < 3 * page_size; ++i)
+   {
+      REQUIRE( pool.addComponent(1000 + i, complicatedType_t<0>()) == static_cast<trecs::uid_t>(1000 + i) );
+   }
+
+   REQUIRE( pool.numAllocatedPages() == 3 );
+   REQUIRE( pool.numPages() == 3 );
+   REQUIRE( pool.getComponent(7) == first );
+   REQUIRE( first->int_field == 99 );
+
+   // Every page but the last is full.
+   pool.removeComponent(1001);
+   REQUIRE( pool.page(0).size() == page_size );
+   REQUIRE( pool.page(1).size() == page_size );
+   REQUIRE( pool.page(2).size() == page_size - 1 );
+   REQUIRE( pool.page(3).empty() );
+
+   // Allocated pages are reused after the pool is cleared.
+   pool.clear();
+   REQUIRE( pool.numPages() == 0 );
+   REQUIRE( pool.numAllocatedPages() == 3 );
+}
+
+TEST_CASE( "components are constructed in place and destroyed on removal", "[ExternalUidObjectPool]" )
+{
+   typedef lifetimeCounter_t<0> counter_t;
+   counter_t::resetCounts();
+
+   {
+      trecs::ExternalUidObjectPool<counter_t> pool(1000);
+
+      // Allocating pages doesn't construct any objects.
+      REQUIRE( pool.emplaceComponent(4, 40) == 4 );
+      REQUIRE( counter_t::num_alive == 1 );
+      REQUIRE( counter_t::num_copies == 0 );
+      REQUIRE( counter_t::num_moves == 0 );
+      REQUIRE( pool.getComponent(4)->value() == 40 );
+
+      // Rvalues are moved into the pool instead of copied.
+      REQUIRE( pool.addComponent(5, counter_t(50)) == 5 );
+      REQUIRE( pool.addComponent(6, counter_t(60)) == 6 );
+      REQUIRE( counter_t::num_alive == 3 );
+      REQUIRE( counter_t::num_copies == 0 );
+      REQUIRE( counter_t::num_moves == 2 );
+
+      // Lvalues are copied into the pool.
+      counter_t seven(70);
+      REQUIRE( pool.addComponent(7, seven) == 7 );
+      REQUIRE( counter_t::num_copies == 1 );
+      REQUIRE( counter_t::num_alive == 5 );
+
+      // Swap-removal moves the last component and destroys the vacated slot.
+      const int moves_before_remove = counter_t::num_moves;
+      pool.removeComponent(4);
+      REQUIRE( counter_t::num_alive == 4 );
+      REQUIRE( counter_t::num_copies == 1 );
+      REQUIRE( counter_t::num_moves == moves_before_remove + 1 );
+      REQUIRE( pool.getComponent(7)->value() == 70 );
+
+      // Removing the last component destroys it without moving anything.
+      pool.removeComponent(6);
+      REQUIRE( counter_t::num_alive == 3 );
+      REQUIRE( counter_t::num_moves == moves_before_remove + 1 );
+
+      pool.clear();
+      REQUIRE( counter_t::num_alive == 1 );
+
+      pool.emplaceComponent(8, 80);
+      REQUIRE( counter_t::num_alive == 2 );
+   }
+
+   // Destroying the pool destroys the components that are still in it.
+   REQUIRE( counter_t::num_alive == 0 );
+}
+
+TEST_CASE( "assignment copies multiple pages of trivially copyable components", "[ExternalUidObjectPool]" )
+{
+   const unsigned int max_size = 10000;
+   trecs::ExternalUidObjectPool<complicatedType_t<2> > alloc(max_size);
+
+   const int num_components = static_cast<int>(3 * alloc.pageSize() + 5);
+   for (int i = 0; i < num_components; ++i)
+   {
+      alloc.addComponent(2 * i, complicatedType_t<2>{i, -1.f * i});
+   }
+
+   alloc.removeComponent(0);
+
+   trecs::ExternalUidObjectPool<complicatedType_t<2> > alloc_b(max_size);
+   alloc_b.addComponent(1, complicatedType_t<2>{});
+
+   alloc_b = alloc;
+
+   REQUIRE( alloc_b.size() == alloc.size() );
+   REQUIRE( alloc_b.numPages() == alloc.numPages() );
+   REQUIRE( alloc_b.getComponent(1) == nullptr );
+   REQUIRE( alloc_b.getComponent(0) == nullptr );
+
+   for (int i = 1; i < num_components; ++i)
+   {
+      REQUIRE( alloc_b.getComponent(2 * i) != alloc.getComponent(2 * i) );
+      REQUIRE( *alloc_b.getComponent(2 * i) == *alloc.getComponent(2 * i) );
+   }
+}
+
+TEST_CASE( "sort pool components", "[ExternalUidObjectPool]" )
+{
+   typedef lifetimeCounter_t<4> counter_t;
+   counter_t::resetCounts();
+
+   {
+      // Small pages make the sort cross page boundaries.
+      trecs::ExternalUidObjectPool<counter_t> pool(10000);
+
+      const int num_components = 3 * static_cast<int>(pool.pageSize()) + 7;
+      for (int i = 0; i < num_components; ++i)
+      {
+         pool.emplaceComponent(i, (i * 7919) % num_components);
+      }
+
+      pool.sort(
+         [](const counter_t & a, const counter_t & b)
+         {
+            return a.value() < b.value();
+         }
+      );
+
+      REQUIRE( pool.size() == static_cast<size_t>(num_components) );
+      REQUIRE( counter_t::num_alive == num_components );
+      REQUIRE( counter_t::num_copies == 0 );
+
+      for (int i = 1; i < num_components; ++i)
+      {
+         REQUIRE( pool.componentAt(i - 1).value() <= pool.componentAt(i).value() );
+      }
+
+      // UIDs still map to their own components.
+      for (int i = 0; i < num_components; ++i)
+      {
+         REQUIRE( pool.getComponent(i)->value() == (i * 7919) % num_components );
+         REQUIRE( &pool.componentAt(i) == pool.getComponent(pool.getUids()[i]) );
+      }
+   }
+
+   REQUIRE( counter_t::num_alive == 0 );
+}
+
+TEST_CASE( "reorder pool components", "[ExternalUidObjectPool]" )
+{
+   trecs::ExternalUidObjectPool<int> pool(100);
+
+   for (int i = 0; i < 10; ++i)
+   {
+      pool.addComponent(i, 10 * i);
+   }
+
+   // Missing and repeated UIDs are skipped.
+   std::vector<trecs::uid_t> front = {7, 2, 50, 7, 9};
+   pool.reorder(front);
+
+   const std::vector<trecs::uid_t> expected = {7, 2, 9, 0, 1, 3, 4, 5, 6, 8};
+   REQUIRE( pool.getUids() == expected );
+
+   for (size_t i = 0; i < expected.size(); ++i)
+   {
+      REQUIRE( pool.componentAt(i) == 10 * expected[i] );
+      REQUIRE( *pool.getComponent(expected[i]) == 10 * expected[i] );
+   }
+
+   pool.removeComponent(7);
+   REQUIRE( pool.getUids()[0] == 8 );
+   REQUIRE( *pool.getComponent(8) == 80 );
+}
+
+TEST_CASE( "add batches of components", "[ExternalUidObjectPool]" )
+{
+   typedef lifetimeCounter_t<1> counter_t;
+   counter_t::resetCounts();
+
+   {
+      trecs::ExternalUidObjectPool<counter_t> pool(10000);
+      const size_t page_size = trecs::ExternalUidObjectPool<counter_t>::pageSize();
+
+      pool.addComponent(9999, counter_t(-1));
+
+      std::vector<trecs::uid_t> uids;
+      for (trecs::uid_t i = 0; i < static_cast<trecs::uid_t>(2 * page_size + 3); ++i)
+      {
+         uids.push_back(i);
+      }
+
+      REQUIRE( pool.addComponents(trecs::Span<const trecs::uid_t>(uids.data(), uids.size()), counter_t(12)) );
+      REQUIRE( pool.size() == uids.size() + 1 );
+      REQUIRE( pool.numAllocatedPages() == pool.numPages() );
+
+      for (const auto uid : uids)
+      {
+         REQUIRE( pool.getComponent(uid)->value() == 12 );
+      }
+
+      // A batch with one bad UID adds nothing.
+      std::vector<trecs::uid_t> bad_uids = {9000, 9001, 5, 9002};
+      REQUIRE( !pool.addComponents(trecs::Span<const trecs::uid_t>(bad_uids.data(), bad_uids.size()), counter_t(3)) );
+
+      std::vector<trecs::uid_t> repeated_uids = {9000, 9001, 9000};
+      REQUIRE( !pool.addComponents(trecs::Span<const trecs::uid_t>(repeated_uids.data(), repeated_uids.size()), counter_t(3)) );
+
+      REQUIRE( pool.size() == uids.size() + 1 );
+      REQUIRE( pool.getComponent(9000) == nullptr );
+      REQUIRE( pool.getComponent(9001) == nullptr );
+
+      // Components copied from a span line up with their UIDs across page
+      // boundaries.
+      std::vector<counter_t> components;
+      std::vector<trecs::uid_t> span_uids;
+      for (int i = 0; i < static_cast<int>(page_size + 7); ++i)
+      {
+         components.push_back(counter_t(i));
+         span_uids.push_back(6000 + i);
+      }
+
+      const int copies_before = counter_t::num_copies;
+      REQUIRE(
+         pool.addComponents(
+            trecs::Span<const trecs::uid_t>(span_uids.data(), span_uids.size()),
+            trecs::Span<const counter_t>(components.data(), components.size())
+         )
+      );
+      REQUIRE( counter_t::num_copies - copies_before == static_cast<int>(components.size()) );
+
+      for (size_t i = 0; i < span_uids.size(); ++i)
+      {
+         REQUIRE( pool.getComponent(span_uids[i])->value() == static_cast<int>(i) );
+      }
+
+      // Mismatched lengths are rejected.
+      REQUIRE(
+         !pool.addComponents(
+            trecs::Span<const trecs::uid_t>(bad_uids.data(), 2),
+            trecs::Span<const counter_t>(components.data(), 3)
+         )
+      );
+   }
+
+   REQUIRE( counter_t::num_alive == 0 );
+}
+
+TEST_CASE( "batches that don't fit are rejected", "[ExternalUidObjectPool]" )
+{
+   trecs::ExternalUidObjectPool<int> pool(10);
+
+   std::vector<trecs::uid_t> uids = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+   REQUIRE( !pool.addComponents(trecs::Span<const trecs::uid_t>(uids.data(), 11), 1) );
+   REQUIRE( pool.size() == 0 );
+
+   REQUIRE( pool.addComponents(trecs::Span<const trecs::uid_t>(uids.data(), 10), 1) );
+   REQUIRE( pool.size() == 10 );
+}
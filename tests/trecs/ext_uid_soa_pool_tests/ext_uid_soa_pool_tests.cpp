@@ -0,0 +1,301 @@
+#include "ext_uid_soa_pool.hpp"
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <vector>
+
+struct vec3_t
+{
+   vec3_t(void)
+   {
+      vec[0] = 0.f;
+      vec[1] = 0.f;
+      vec[2] = 0.f;
+   }
+
+   vec3_t(float x, float y, float z)
+   {
+      vec[0] = x;
+      vec[1] = y;
+      vec[2] = z;
+   }
+
+   float vec[3];
+};
+
+namespace trecs
+{
+   template <>
+   struct SoaTraits<vec3_t>
+   {
+      static const bool enabled = true;
+      static const size_t num_fields = 3;
+
+      static float getField(const vec3_t & v, size_t field)
+      {
+         return v.vec[field];
+      }
+
+      static void setField(vec3_t & v, size_t field, float value)
+      {
+         v.vec[field] = value;
+      }
+   };
+}
+
+TEST_CASE( "add and read soa components", "[ExternalUidSoaPool]" )
+{
+   trecs::ExternalUidSoaPool<vec3_t> pool(100);
+
+   REQUIRE( pool.size() == 0 );
+
+   for (int i = 0; i < 20; ++i)
+   {
+      REQUIRE( pool.addComponent(3 * i, vec3_t(i, 2.f * i, 3.f * i)) == 3 * i );
+   }
+
+   // Adding a duplicate UID fails.
+   REQUIRE( pool.addComponent(3, vec3_t()) == -1 );
+
+   REQUIRE( pool.size() == 20 );
+   REQUIRE( pool.hasComponent(6) );
+   REQUIRE( !pool.hasComponent(7) );
+
+   vec3_t v;
+   REQUIRE( pool.readComponent(9, v) );
+   REQUIRE( v.vec[0] == 3.f );
+   REQUIRE( v.vec[1] == 6.f );
+   REQUIRE( v.vec[2] == 9.f );
+
+   REQUIRE( !pool.readComponent(10, v) );
+
+   REQUIRE( pool.writeComponent(9, vec3_t(-1.f, -2.f, -3.f)) );
+   REQUIRE( !pool.writeComponent(10, vec3_t()) );
+   REQUIRE( pool.readComponent(9, v) );
+   REQUIRE( v.vec[2] == -3.f );
+}
+
+TEST_CASE( "soa columns are aligned and padded", "[ExternalUidSoaPool]" )
+{
+   trecs::ExternalUidSoaPool<vec3_t> pool(1000);
+
+   for (int i = 0; i < 13; ++i)
+   {
+      pool.emplaceComponent(i, 1.f * i, 0.f, -1.f * i);
+   }
+
+   trecs::SoaView<vec3_t> view = pool.view();
+
+   REQUIRE( view.size() == 13 );
+   REQUIRE( view.paddedSize() % trecs::soa_lane_width == 0 );
+   REQUIRE( view.paddedSize() >= view.size() );
+   REQUIRE( view.uids().size() == 13 );
+   REQUIRE( view.column(3) == nullptr );
+
+   for (size_t field = 0; field < 3; ++field)
+   {
+      const float * column = view.column(field);
+      REQUIRE( reinterpret_cast<size_t>(column) % trecs::soa_column_alignment == 0 );
+
+      // The tail padding is zeroed.
+      for (size_t i = view.size(); i < view.paddedSize(); ++i)
+      {
+         REQUIRE( column[i] == 0.f );
+      }
+   }
+
+   for (size_t i = 0; i < view.size(); ++i)
+   {
+      const float uid = static_cast<float>(view.uids()[i]);
+      REQUIRE( view.column(0)[i] == uid );
+      REQUIRE( view.column(2)[i] == -uid );
+   }
+}
+
+TEST_CASE( "removing soa components keeps columns packed", "[ExternalUidSoaPool]" )
+{
+   trecs::ExternalUidSoaPool<vec3_t> pool(1000);
+
+   const int num_components = 200;
+   for (int i = 0; i < num_components; ++i)
+   {
+      pool.addComponent(i, vec3_t(i, i + 1.f, i + 2.f));
+   }
+
+   for (int i = 0; i < num_components; i += 2)
+   {
+      pool.removeComponent(i);
+   }
+
+   // Removing a missing component does nothing.
+   pool.removeComponent(0);
+
+   REQUIRE( pool.size() == num_components / 2 );
+
+   trecs::SoaView<vec3_t> view = pool.view();
+   for (size_t i = 0; i < view.size(); ++i)
+   {
+      const trecs::uid_t uid = view.uids()[i];
+      REQUIRE( uid % 2 == 1 );
+      REQUIRE( view.column(1)[i] == uid + 1.f );
+   }
+
+   for (size_t i = view.size(); i < view.paddedSize(); ++i)
+   {
+      REQUIRE( view.column(0)[i] == 0.f );
+   }
+
+   std::vector<trecs::uid_t> uids = pool.getUids();
+   std::sort(uids.begin(), uids.end());
+   REQUIRE( uids.size() == num_components / 2 );
+   REQUIRE( uids.front() == 1 );
+   REQUIRE( uids.back() == num_components - 1 );
+}
+
+TEST_CASE( "soa pool assignment and clear", "[ExternalUidSoaPool]" )
+{
+   trecs::ExternalUidSoaPool<vec3_t> pool_a(100);
+   trecs::ExternalUidSoaPool<vec3_t> pool_b(100);
+
+   for (int i = 0; i < 30; ++i)
+   {
+      pool_a.addComponent(i, vec3_t(i, i, i));
+   }
+
+   pool_b.addComponent(50, vec3_t(5.f, 5.f, 5.f));
+
+   pool_b = pool_a;
+
+   REQUIRE( pool_b.size() == 30 );
+   REQUIRE( !pool_b.hasComponent(50) );
+
+   vec3_t v;
+   REQUIRE( pool_b.readComponent(17, v) );
+   REQUIRE( v.vec[1] == 17.f );
+
+   // The copy is independent of the original.
+   pool_b.writeComponent(17, vec3_t());
+   REQUIRE( pool_a.readComponent(17, v) );
+   REQUIRE( v.vec[1] == 17.f );
+
+   pool_a.clear();
+   REQUIRE( pool_a.size() == 0 );
+   REQUIRE( !pool_a.hasComponent(17) );
+   REQUIRE( pool_a.addComponent(17, vec3_t()) == 17 );
+}
+
+TEST_CASE( "soa pool uses a memory resource", "[ExternalUidSoaPool]" )
+{
+   trecs::ArenaMemoryResource arena(1024 * 1024);
+
+   {
+      trecs::ExternalUidSoaPool<vec3_t> pool(100, &arena);
+
+      for (int i = 0; i < 100; ++i)
+      {
+         pool.addComponent(i, vec3_t());
+      }
+
+      REQUIRE( arena.owns(pool.view().column(0)) );
+      REQUIRE( arena.numUpstreamAllocations() == 0 );
+   }
+}
+
+TEST_CASE( "sort and reorder soa components", "[ExternalUidSoaPool]" )
+{
+   trecs::ExternalUidSoaPool<vec3_t> pool(1000);
+
+   const int num_components = 100;
+   for (int i = 0; i < num_components; ++i)
+   {
+      const float key = static_cast<float>((i * 37) % num_components);
+      pool.addComponent(i, vec3_t(key, 0.f, static_cast<float>(i)));
+   }
+
+   pool.sort(
+      [](const vec3_t & a, const vec3_t & b)
+      {
+         return a.vec[0] > b.vec[0];
+      }
+   );
+
+   trecs::SoaView<vec3_t> view = pool.view();
+   for (size_t i = 1; i < view.size(); ++i)
+   {
+      REQUIRE( view.column(0)[i - 1] >= view.column(0)[i] );
+   }
+
+   for (size_t i = 0; i < view.size(); ++i)
+   {
+      REQUIRE( view.column(2)[i] == static_cast<float>(view.uids()[i]) );
+   }
+
+   std::vector<trecs::uid_t> front = {5, 3, 1};
+   pool.reorder(front);
+
+   view = pool.view();
+   REQUIRE( view.uids()[0] == 5 );
+   REQUIRE( view.uids()[1] == 3 );
+   REQUIRE( view.uids()[2] == 1 );
+
+   vec3_t v;
+   for (int i = 0; i < num_components; ++i)
+   {
+      REQUIRE( pool.readComponent(i, v) );
+      REQUIRE( v.vec[2] == static_cast<float>(i) );
+   }
+}
+
+TEST_CASE( "add batches of soa components", "[ExternalUidSoaPool]" )
+{
+   trecs::ExternalUidSoaPool<vec3_t> pool(1000);
+
+   pool.addComponent(900, vec3_t(-1.f, -1.f, -1.f));
+
+   std::vector<trecs::uid_t> uids;
+   for (trecs::uid_t i = 0; i < 100; ++i)
+   {
+      uids.push_back(i);
+   }
+
+   REQUIRE( pool.addComponents(trecs::Span<const trecs::uid_t>(uids.data(), uids.size()), vec3_t(1.f, 2.f, 3.f)) );
+   REQUIRE( pool.size() == 101 );
+
+   std::vector<vec3_t> components;
+   std::vector<trecs::uid_t> span_uids;
+   for (int i = 0; i < 50; ++i)
+   {
+      components.push_back(vec3_t(i, 0.f, 0.f));
+      span_uids.push_back(200 + i);
+   }
+
+   REQUIRE(
+      pool.addComponents(
+         trecs::Span<const trecs::uid_t>(span_uids.data(), span_uids.size()),
+         trecs::Span<const vec3_t>(components.data(), components.size())
+      )
+   );
+
+   // A batch with a UID that's already in the pool adds nothing.
+   std::vector<trecs::uid_t> bad_uids = {500, 900};
+   REQUIRE( !pool.addComponents(trecs::Span<const trecs::uid_t>(bad_uids.data(), bad_uids.size()), vec3_t()) );
+   REQUIRE( !pool.hasComponent(500) );
+   REQUIRE( pool.size() == 151 );
+
+   vec3_t v;
+   REQUIRE( pool.readComponent(42, v) );
+   REQUIRE( v.vec[2] == 3.f );
+   REQUIRE( pool.readComponent(230, v) );
+   REQUIRE( v.vec[0] == 30.f );
+   REQUIRE( pool.readComponent(900, v) );
+   REQUIRE( v.vec[1] == -1.f );
+
+   trecs::SoaView<vec3_t> view = pool.view();
+   for (size_t i = view.size(); i < view.paddedSize(); ++i)
+   {
+      REQUIRE( view.column(1)[i] == 0.f );
+   }
+}
@@ -0,0 +1,109 @@
+#include "memory_resource.hpp"
+
+#include "ext_uid_object_pool.hpp"
+
+#include "complicated_types.hpp"
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+
+#include <cstdint>
+
+TEST_CASE( "default resource returns aligned memory", "[MemoryResource]" )
+{
+   trecs::IMemoryResource * resource = trecs::defaultMemoryResource();
+
+   REQUIRE( resource == trecs::defaultMemoryResource() );
+
+   const size_t alignments[] = {1, 8, 16, 64, 4096};
+   for (const auto alignment : alignments)
+   {
+      void * ptr = resource->allocate(100, alignment);
+      REQUIRE( ptr != nullptr );
+      REQUIRE( (reinterpret_cast<uintptr_t>(ptr) % alignment) == 0 );
+      resource->deallocate(ptr, 100, alignment);
+   }
+}
+
+TEST_CASE( "arena hands out aligned memory from one region", "[MemoryResource]" )
+{
+   trecs::ArenaMemoryResource arena(1 << 20);
+
+   REQUIRE( arena.capacity() >= (1 << 20) );
+   REQUIRE( arena.bytesUsed() == 0 );
+
+   void * a = arena.allocate(3, 1);
+   void * b = arena.allocate(40, 32);
+   void * c = arena.allocate(8, 8);
+
+   REQUIRE( arena.owns(a) );
+   REQUIRE( arena.owns(b) );
+   REQUIRE( arena.owns(c) );
+   REQUIRE( (reinterpret_cast<uintptr_t>(b) % 32) == 0 );
+   REQUIRE( (reinterpret_cast<uintptr_t>(c) % 8) == 0 );
+   REQUIRE( static_cast<unsigned char *>(b) > static_cast<unsigned char *>(a) );
+   REQUIRE( static_cast<unsigned char *>(c) >= static_cast<unsigned char *>(b) + 40 );
+
+   // Deallocating from the arena is a no-op.
+   const size_t used = arena.bytesUsed();
+   arena.deallocate(b, 40, 32);
+   REQUIRE( arena.bytesUsed() == used );
+
+   // Releasing the arena makes all of its memory available again.
+   arena.release();
+   REQUIRE( arena.bytesUsed() == 0 );
+   REQUIRE( arena.allocate(3, 1) == a );
+}
+
+TEST_CASE( "arena forwards oversized requests upstream", "[MemoryResource]" )
+{
+   trecs::ArenaMemoryResource arena(1024);
+
+   const size_t too_big = arena.capacity() + 1;
+   void * big = arena.allocate(too_big, 16);
+
+   REQUIRE( big != nullptr );
+   REQUIRE( !arena.owns(big) );
+   REQUIRE( arena.numUpstreamAllocations() == 1 );
+
+   arena.deallocate(big, too_big, 16);
+   REQUIRE( arena.numUpstreamAllocations() == 0 );
+
+   arena.allocate(too_big, 16);
+   arena.allocate(too_big, 16);
+   REQUIRE( arena.numUpstreamAllocations() == 2 );
+
+   arena.release();
+   REQUIRE( arena.numUpstreamAllocations() == 0 );
+}
+
+TEST_CASE( "pools allocate from an arena", "[MemoryResource]" )
+{
+   trecs::ArenaMemoryResource arena(4 << 20);
+
+   {
+      trecs::ExternalUidObjectPool<complicatedType_t<0> > pool(5000, &arena);
+
+      REQUIRE( arena.bytesUsed() == 0 );
+
+      for (int i = 0; i < 2000; ++i)
+      {
+         complicatedType_t<0> component;
+         component.int_field = i;
+         REQUIRE( pool.addComponent(3 * i, component) == 3 * i );
+      }
+
+      REQUIRE( arena.bytesUsed() > 0 );
+      REQUIRE( arena.numUpstreamAllocations() == 0 );
+
+      for (int i = 0; i < 2000; ++i)
+      {
+         REQUIRE( arena.owns(pool.getComponent(3 * i)) );
+         REQUIRE( pool.getComponent(3 * i)->int_field == i );
+      }
+   }
+
+   arena.release();
+   REQUIRE( arena.bytesUsed() == 0 );
+}
@@ -0,0 +1,85 @@
+#include "paged_sparse_array.hpp"
+
+#define CATCH_CONFIG_MAIN
+
+#include "catch.hpp"
+
+TEST_CASE( "empty array returns default values", "[PagedSparseArray]" )
+{
+   trecs::PagedSparseArray<int, 64> arr(-7);
+
+   REQUIRE( arr.get(0) == -7 );
+   REQUIRE( arr.get(12345) == -7 );
+   REQUIRE( arr.get(-1) == -7 );
+   REQUIRE( arr.numPages() == 0 );
+}
+
+TEST_CASE( "pages are only allocated for written UIDs", "[PagedSparseArray]" )
+{
+   trecs::PagedSparseArray<int, 64> arr(-1);
+
+   arr.set(3, 10);
+   REQUIRE( arr.numPages() == 1 );
+
+   arr.set(63, 11);
+   REQUIRE( arr.numPages() == 1 );
+
+   arr.set(64 * 100 + 5, 12);
+   REQUIRE( arr.numPages() == 2 );
+
+   REQUIRE( arr.get(3) == 10 );
+   REQUIRE( arr.get(63) == 11 );
+   REQUIRE( arr.get(64 * 100 + 5) == 12 );
+
+   // Untouched UIDs in allocated and unallocated pages return the default.
+   REQUIRE( arr.get(4) == -1 );
+   REQUIRE( arr.get(64 * 50) == -1 );
+
+   // Resetting a UID in an unallocated page doesn't allocate it.
+   arr.reset(64 * 50);
+   REQUIRE( arr.numPages() == 2 );
+
+   arr.reset(3);
+   REQUIRE( arr.get(3) == -1 );
+}
+
+TEST_CASE( "negative UIDs are ignored", "[PagedSparseArray]" )
+{
+   trecs::PagedSparseArray<int, 64> arr(0);
+
+   arr.set(-5, 100);
+
+   REQUIRE( arr.get(-5) == 0 );
+   REQUIRE( arr.numPages() == 0 );
+}
+
+TEST_CASE( "copies are deep", "[PagedSparseArray]" )
+{
+   trecs::PagedSparseArray<int, 64> arr_a(-1);
+   for (int i = 0; i < 1000; i += 7)
+   {
+      arr_a.set(i, 2 * i);
+   }
+
+   trecs::PagedSparseArray<int, 64> arr_b(-2);
+   arr_b.set(5000, 1);
+
+   arr_b = arr_a;
+
+   REQUIRE( arr_b.numPages() == arr_a.numPages() );
+   REQUIRE( arr_b.get(5000) == -1 );
+
+   for (int i = 0; i < 1000; ++i)
+   {
+      REQUIRE( arr_b.get(i) == arr_a.get(i) );
+   }
+
+   arr_a.set(7, 3);
+   REQUIRE( arr_b.get(7) == 14 );
+
+   trecs::PagedSparseArray<int, 64> arr_c(arr_b);
+   arr_b.clear();
+
+   REQUIRE( arr_b.numPages() == 0 );
+   REQUIRE( arr_c.get(14) == 28 );
+}
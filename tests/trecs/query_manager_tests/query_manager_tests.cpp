@@ -4,6 +4,9 @@
 
 #include "catch.hpp"
 
+#include <random>
+#include <vector>
+
 trecs::DefaultArchetype archFromBits(int bits)
 {
    trecs::DefaultArchetype arch;
@@ -303,6 +306,59 @@ TEST_CASE( "add entities with supported archetypes", "[QueryManager]" )
    REQUIRE( queries.getArchetypeEntities(query_b).size() == 8 );
 }
 
+TEST_CASE( "add a batch of entities with one archetype", "[QueryManager]" )
+{
+   trecs::QueryManager queries;
+
+   trecs::query_t query_a = queries.addArchetypeQuery(archFromBits(0b0011));
+   trecs::query_t query_b = queries.addArchetypeQuery(archFromBits(0b0100));
+   trecs::query_t query_c = queries.addArchetypeQuery(archFromBits(0b0001));
+
+   queries.moveEntity(100, archFromBits(0), archFromBits(0b0001));
+
+   std::vector<trecs::uid_t> entities;
+   for (trecs::uid_t i = 0; i < 50; ++i)
+   {
+      entities.push_back(i);
+   }
+
+   queries.addEntities(entities, archFromBits(0b1011));
+
+   REQUIRE( queries.getArchetypeEntities(query_a).size() == 50 );
+   REQUIRE( queries.getArchetypeEntities(query_b).size() == 0 );
+   REQUIRE( queries.getArchetypeEntities(query_c).size() == 51 );
+
+   queries.removeEntity(7);
+   REQUIRE( !queries.hasEntity(query_a, 7) );
+   REQUIRE( queries.getArchetypeEntities(query_c).size() == 50 );
+}
+
+TEST_CASE( "remove a batch of entities with one archetype", "[QueryManager]" )
+{
+   trecs::QueryManager queries;
+
+   trecs::query_t query_a = queries.addArchetypeQuery(archFromBits(0b0011));
+   trecs::query_t query_b = queries.addArchetypeQuery(archFromBits(0b0100));
+
+   std::vector<trecs::uid_t> entities_a;
+   std::vector<trecs::uid_t> entities_b;
+   for (trecs::uid_t i = 0; i < 20; ++i)
+   {
+      entities_a.push_back(i);
+      entities_b.push_back(i + 20);
+   }
+
+   queries.addEntities(entities_a, archFromBits(0b0011));
+   queries.addEntities(entities_b, archFromBits(0b0100));
+
+   entities_a.resize(15);
+   queries.removeEntities(entities_a, archFromBits(0b0011));
+
+   REQUIRE( queries.getArchetypeEntities(query_a).size() == 5 );
+   REQUIRE( queries.hasEntity(query_a, 17) );
+   REQUIRE( queries.getArchetypeEntities(query_b).size() == 20 );
+}
+
 TEST_CASE( "add and remove node entities", "[QueryManager]" )
 {
    trecs::QueryManager queries;
@@ -364,6 +420,263 @@ TEST_CASE( "add node entities with archetype subset", "[QueryManager]" )
    
 }
 
+// Moves entities between archetypes that span several signature blocks and
+// checks every query's membership against a brute-force subset test.
+TEST_CASE( "moving entities only updates queries with changed signatures", "[QueryManager]" )
+{
+   trecs::QueryManager queries;
+
+   std::mt19937 rng(4321);
+   std::uniform_int_distribution<int> pick_sig(0, trecs::max_num_signatures - 1);
+
+   std::vector<trecs::query_t> query_ids;
+   for (int i = 0; i < 300; ++i)
+   {
+      trecs::DefaultArchetype arch;
+      const int num_sigs = 1 + (i % 3);
+      for (int j = 0; j < num_sigs; ++j)
+      {
+         arch.mergeSignature(pick_sig(rng));
+      }
+      query_ids.push_back(queries.addArchetypeQuery(arch));
+   }
+
+   const int num_entities = 50;
+   std::vector<trecs::DefaultArchetype> entity_archs(num_entities);
+
+   for (int step = 0; step < 2000; ++step)
+   {
+      const trecs::uid_t entity = step % num_entities;
+      const trecs::signature_t sig = pick_sig(rng);
+      trecs::DefaultArchetype new_arch = entity_archs[entity];
+      if (new_arch.supports(sig))
+      {
+         new_arch.removeSignature(sig);
+      }
+      else
+      {
+         new_arch.mergeSignature(sig);
+      }
+
+      queries.moveEntity(entity, entity_archs[entity], new_arch);
+      entity_archs[entity] = new_arch;
+   }
+
+   for (const auto query_id : query_ids)
+   {
+      const trecs::DefaultArchetype query_arch = queries.getArchetype(query_id);
+      size_t num_expected = 0;
+
+      for (trecs::uid_t entity = 0; entity < num_entities; ++entity)
+      {
+         const bool expected = query_arch.supports(entity_archs[entity]);
+         REQUIRE( queries.hasEntity(query_id, entity) == expected );
+         num_expected += expected;
+      }
+
+      REQUIRE( queries.getArchetypeEntities(query_id).size() == num_expected );
+   }
+}
+
+TEST_CASE( "archetype graph edges follow queries registered later", "[QueryManager]" )
+{
+   trecs::QueryManager queries;
+
+   const trecs::query_t query_a = queries.addArchetypeQuery(archFromBits(0x1));
+   const trecs::query_t query_ab = queries.addArchetypeQuery(archFromBits(0x3));
+
+   // Moves entities back and forth along the same edges to cache them.
+   for (int round = 0; round < 3; ++round)
+   {
+      queries.moveEntity(0, archFromBits(0x0), archFromBits(0x1));
+      queries.moveEntity(0, archFromBits(0x1), archFromBits(0x3));
+      REQUIRE( queries.hasEntity(query_a, 0) );
+      REQUIRE( queries.hasEntity(query_ab, 0) );
+
+      queries.moveEntity(0, archFromBits(0x3), archFromBits(0x1));
+      REQUIRE( queries.hasEntity(query_a, 0) );
+      REQUIRE( !queries.hasEntity(query_ab, 0) );
+
+      queries.moveEntity(0, archFromBits(0x1), archFromBits(0x0));
+      REQUIRE( !queries.hasEntity(query_a, 0) );
+   }
+
+   REQUIRE( queries.numArchetypeNodes() == 3 );
+
+   // Queries registered after the edges are cached are added to them.
+   trecs::DefaultArchetype excluded_b = archFromBits(0x2);
+   const trecs::query_t query_a_not_b = queries.addArchetypeQuery(
+      archFromBits(0x1), excluded_b
+   );
+
+   queries.moveEntity(1, archFromBits(0x0), archFromBits(0x1));
+   REQUIRE( queries.hasEntity(query_a_not_b, 1) );
+
+   queries.moveEntity(1, archFromBits(0x1), archFromBits(0x3));
+   REQUIRE( !queries.hasEntity(query_a_not_b, 1) );
+   REQUIRE( queries.hasEntity(query_ab, 1) );
+
+   queries.moveEntity(1, archFromBits(0x3), archFromBits(0x1));
+   REQUIRE( queries.hasEntity(query_a_not_b, 1) );
+   REQUIRE( !queries.hasEntity(query_ab, 1) );
+
+   // Moves that change several signatures at once skip the edges.
+   queries.moveEntity(2, archFromBits(0x0), archFromBits(0x7));
+   REQUIRE( queries.hasEntity(query_a, 2) );
+   REQUIRE( queries.hasEntity(query_ab, 2) );
+   REQUIRE( !queries.hasEntity(query_a_not_b, 2) );
+   REQUIRE( queries.numArchetypeNodes() == 4 );
+
+   queries.removeEntity(2, archFromBits(0x7));
+   REQUIRE( !queries.hasEntity(query_a, 2) );
+   REQUIRE( !queries.hasEntity(query_ab, 2) );
+   REQUIRE( queries.hasEntity(query_a, 1) );
+}
+
+TEST_CASE( "queries registered later are backfilled with existing entities", "[QueryManager]" )
+{
+   trecs::QueryManager queries;
+
+   // 0b011 for entities 0-9, 0b101 for entities 10-19, 0b111 for 20-29.
+   std::vector<trecs::uid_t> entities_ab;
+   std::vector<trecs::uid_t> entities_ac;
+   for (trecs::uid_t i = 0; i < 10; ++i)
+   {
+      entities_ab.push_back(i);
+      entities_ac.push_back(i + 10);
+      queries.moveEntity(i + 20, archFromBits(0x0), archFromBits(0x7));
+   }
+
+   queries.addEntities(entities_ab, archFromBits(0x3));
+   queries.addEntities(entities_ac, archFromBits(0x5));
+
+   REQUIRE( queries.getExactArchetypeEntities(archFromBits(0x3)).size() == 10 );
+   REQUIRE( queries.getExactArchetypeEntities(archFromBits(0x7)).size() == 10 );
+   REQUIRE( queries.getExactArchetypeEntities(archFromBits(0x2)).size() == 0 );
+
+   // Entities that move or are removed leave their old archetype.
+   queries.moveEntity(0, archFromBits(0x3), archFromBits(0x1));
+   queries.removeEntity(10, archFromBits(0x5));
+   REQUIRE( queries.getExactArchetypeEntities(archFromBits(0x3)).size() == 9 );
+   REQUIRE( queries.getExactArchetypeEntities(archFromBits(0x1)).size() == 1 );
+   REQUIRE( queries.getExactArchetypeEntities(archFromBits(0x5)).size() == 9 );
+
+   const trecs::query_t query_a = queries.addArchetypeQuery(archFromBits(0x1));
+   REQUIRE( queries.getArchetypeEntities(query_a).size() == 29 );
+   REQUIRE( queries.hasEntity(query_a, 0) );
+   REQUIRE( !queries.hasEntity(query_a, 10) );
+
+   const trecs::query_t query_b = queries.addArchetypeQuery(archFromBits(0x2));
+   REQUIRE( queries.getArchetypeEntities(query_b).size() == 19 );
+
+   trecs::DefaultArchetype excluded_c = archFromBits(0x4);
+   const trecs::query_t query_a_not_c = queries.addArchetypeQuery(
+      archFromBits(0x1), excluded_c
+   );
+   REQUIRE( queries.getArchetypeEntities(query_a_not_c).size() == 10 );
+   for (trecs::uid_t i = 0; i < 10; ++i)
+   {
+      REQUIRE( queries.hasEntity(query_a_not_c, i) );
+   }
+
+   // Backfilled queries keep following their entities.
+   queries.moveEntity(1, archFromBits(0x3), archFromBits(0x7));
+   REQUIRE( !queries.hasEntity(query_a_not_c, 1) );
+   REQUIRE( queries.hasEntity(query_b, 1) );
+}
+
+TEST_CASE( "query entities are dense and keep insertion order", "[QueryManager]" )
+{
+   trecs::QueryManager queries;
+
+   trecs::query_t query_a = queries.addArchetypeQuery(archFromBits(0b0011));
+
+   for (trecs::uid_t i = 0; i < 10; ++i)
+   {
+      queries.moveEntity(9 - i, archFromBits(0), archFromBits(0b0111));
+   }
+
+   auto entities = queries.getArchetypeEntities(query_a);
+   REQUIRE( entities.size() == 10 );
+   for (size_t i = 0; i < entities.size(); ++i)
+   {
+      REQUIRE( entities[i] == static_cast<trecs::uid_t>(9 - i) );
+   }
+
+   // Removing an entity moves the last entity into its place.
+   queries.removeEntity(7);
+   entities = queries.getArchetypeEntities(query_a);
+   REQUIRE( entities.size() == 9 );
+   REQUIRE( entities[2] == 0 );
+   REQUIRE( entities[entities.size() - 1] == 1 );
+   REQUIRE( !queries.hasEntity(query_a, 7) );
+
+   // Moving to an archetype that still matches doesn't reorder anything.
+   queries.moveEntity(5, archFromBits(0b0111), archFromBits(0b1111));
+   entities = queries.getArchetypeEntities(query_a);
+   REQUIRE( entities.size() == 9 );
+   REQUIRE( entities[4] == 5 );
+
+   // Moving out of the query and back in appends the entity.
+   queries.moveEntity(5, archFromBits(0b1111), archFromBits(0b0100));
+   REQUIRE( !queries.hasEntity(query_a, 5) );
+   queries.moveEntity(5, archFromBits(0b0100), archFromBits(0b0011));
+   entities = queries.getArchetypeEntities(query_a);
+   REQUIRE( entities[entities.size() - 1] == 5 );
+
+   queries.sortEntities(query_a);
+   entities = queries.getArchetypeEntities(query_a);
+   for (size_t i = 1; i < entities.size(); ++i)
+   {
+      REQUIRE( entities[i - 1] < entities[i] );
+   }
+
+   // Positions are rebuilt after sorting.
+   queries.removeEntity(0);
+   entities = queries.getArchetypeEntities(query_a);
+   REQUIRE( entities.size() == 8 );
+   REQUIRE( entities[0] == 9 );
+   REQUIRE( queries.hasEntity(query_a, 1) );
+}
+
+TEST_CASE( "queries with excluded signatures", "[QueryManager]" )
+{
+   trecs::QueryManager queries;
+
+   trecs::query_t query_a = queries.addArchetypeQuery(archFromBits(0b0001));
+   trecs::query_t query_b = queries.addArchetypeQuery(archFromBits(0b0001), archFromBits(0b0100));
+
+   // The same archetype with different exclusions is a different query.
+   REQUIRE( query_a != query_b );
+   REQUIRE( queries.addArchetypeQuery(archFromBits(0b0001), archFromBits(0b0100)) == query_b );
+   REQUIRE( queries.getArchetype(query_b) == archFromBits(0b0001) );
+   REQUIRE( queries.getExcludedArchetype(query_b) == archFromBits(0b0100) );
+   REQUIRE( queries.getExcludedArchetype(query_a).empty() );
+
+   queries.moveEntity(0, archFromBits(0), archFromBits(0b0011));
+   queries.moveEntity(1, archFromBits(0), archFromBits(0b0101));
+
+   REQUIRE( queries.hasEntity(query_a, 0) );
+   REQUIRE( queries.hasEntity(query_a, 1) );
+   REQUIRE( queries.hasEntity(query_b, 0) );
+   REQUIRE( !queries.hasEntity(query_b, 1) );
+
+   // Gaining an excluded signature leaves the query, losing it rejoins.
+   queries.moveEntity(0, archFromBits(0b0011), archFromBits(0b0111));
+   REQUIRE( !queries.hasEntity(query_b, 0) );
+   REQUIRE( queries.hasEntity(query_a, 0) );
+
+   queries.moveEntity(1, archFromBits(0b0101), archFromBits(0b0001));
+   REQUIRE( queries.hasEntity(query_b, 1) );
+
+   std::vector<trecs::uid_t> batch = {10, 11, 12};
+   queries.addEntities(batch, archFromBits(0b0101));
+   REQUIRE( queries.getArchetypeEntities(query_a).size() == 5 );
+   REQUIRE( queries.getArchetypeEntities(query_b).size() == 1 );
+
+   REQUIRE( !queries.supportsArchetype(archFromBits(0b0100)) );
+}
+
 TEST_CASE( "retrieve non-existent query from empty manager", "[QueryManager]" )
 {
    trecs::QueryManager queries;
@@ -2,14 +2,18 @@
 #define ALLOCATOR_HEADER
 
 #include "archetype.hpp"
+#include "change_ticks.hpp"
 #include "component_manager.hpp"
 #include "ecs_types.hpp"
 #include "entity_component_buffer.hpp"
 #include "entity_manager.hpp"
 #include "system_manager.hpp"
 #include "query_manager.hpp"
+#include "query_view.hpp"
 
 #include <type_traits>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace trecs
@@ -24,21 +28,118 @@ namespace trecs
 
          Allocator(unsigned int max_num_entities);
 
+         // Creates an allocator whose components are laid out according to
+         // the requested storage mode.
+         Allocator(
+            unsigned int max_num_entities, component_storage_enum_t storage
+         );
+
+         // Creates an allocator whose component pools, archetype chunks, and
+         // ECB's all allocate from one memory resource, e.g. an
+         // 'ArenaMemoryResource'. The allocator doesn't own the resource,
+         // which must outlive the allocator.
+         Allocator(
+            unsigned int max_num_entities,
+            component_storage_enum_t storage,
+            IMemoryResource * resource
+         );
+
          unsigned int maxEntities(void) const
          {
             return max_num_entities_;
          }
 
+         component_storage_enum_t storageMode(void) const
+         {
+            return components_.storageMode();
+         }
+
+         IMemoryResource * memoryResource(void) const
+         {
+            return components_.memoryResource();
+         }
+
          uid_t addEntity(void);
 
          uid_t addEntity(uid_t node_entity_a, uid_t node_entity_b);
 
          uid_t addEntity(uid_t node_entity);
 
+         // Reserves up to 'count' entity UIDs that one thread can take
+         // without synchronization, see 'UidReservation'. Reservations are
+         // made, added, and released on the thread that owns the allocator.
+         UidReservation reserveEntities(size_t count)
+         {
+            return entities_.reserveUids(count);
+         }
+
+         // Adds an entity with a UID that was taken from a reservation.
+         // Returns the entity UID, or -1 if the UID isn't reserved.
+         uid_t addReservedEntity(uid_t entity_uid)
+         {
+            return entities_.addReservedEntity(entity_uid);
+         }
+
+         // Returns the UIDs that haven't been taken from a reservation.
+         void releaseReservation(UidReservation & reservation)
+         {
+            entities_.releaseReservation(reservation);
+         }
+
+         // Returns a UID that was taken from a reservation but never added.
+         void releaseReservedUid(uid_t entity_uid)
+         {
+            entities_.releaseUid(entity_uid);
+         }
+
          const std::vector<uid_t> & getEntities(void) const;
 
          void removeEntity(uid_t entity_uid);
 
+         // Removes a batch of entities. Entities are grouped by archetype so
+         // that only the component pools and queries their archetypes
+         // contain are touched, and edges are cleaned up once for the whole
+         // batch. Inactive and repeated UIDs are skipped.
+         void removeEntities(Span<const uid_t> entity_uids);
+
+         // Removes every entity that matches an archetype query.
+         void removeEntities(const query_t arch_query);
+
+         // Returns a handle to an active entity that can be cached across
+         // updates, or 'error_entity_handle' if the entity isn't active.
+         entity_handle_t getEntityHandle(uid_t entity_uid) const;
+
+         // Returns true if the handle's entity hasn't been removed since the
+         // handle was made. This is a constant-time check.
+         bool entityHandleValid(entity_handle_t handle) const;
+
+         // Returns the UID of the entity referred to by a handle, or -1 if
+         // the handle is stale.
+         uid_t getEntityUid(entity_handle_t handle) const;
+
+         // Disables an active entity. Disabled entities keep their
+         // components and stay in their queries' entity sets, but they're
+         // skipped by 'forEachQueryEntity'. This is constant time and doesn't
+         // touch any pools or queries. Returns false if the entity isn't
+         // active.
+         bool disableEntity(uid_t entity_uid)
+         {
+            return entities_.setEnabled(entity_uid, false);
+         }
+
+         // Re-enables an active entity. Returns false if the entity isn't
+         // active.
+         bool enableEntity(uid_t entity_uid)
+         {
+            return entities_.setEnabled(entity_uid, true);
+         }
+
+         // Returns true if the entity is active and enabled.
+         bool entityEnabled(uid_t entity_uid) const
+         {
+            return entities_.entityEnabled(entity_uid);
+         }
+
          edge_t getEdge(uid_t edge_entity_uid);
 
          edge_t updateEdge(
@@ -72,14 +173,29 @@ namespace trecs
          template <typename Component_T>
          bool addComponent(uid_t entity_uid, const Component_T & component)
          {
-            Component_T * old_component = components_.getComponent<Component_T>(entity_uid);
+            return emplaceComponent<Component_T>(entity_uid, component);
+         }
 
-            if (old_component != nullptr)
-            {
-               std::cout << "Component type " << typeid(Component_T).name() << " already exists on entity " << entity_uid << "\n";
-               return false;
-            }
+         // Attempts to move a component onto an entity UID. Follows the same
+         // rules as adding a component by const reference.
+         template <typename Component_T>
+         typename std::enable_if<
+            !std::is_lvalue_reference<Component_T>::value &&
+            !std::is_same<Component_T, EntityComponentBuffer>::value,
+            bool
+         >::type addComponent(uid_t entity_uid, Component_T && component)
+         {
+            return emplaceComponent<Component_T>(
+               entity_uid, std::move(component)
+            );
+         }
 
+         // Attempts to construct a component in place on an entity UID from a
+         // list of constructor arguments. Follows the same rules as adding a
+         // component by const reference.
+         template <typename Component_T, typename...Args>
+         bool emplaceComponent(uid_t entity_uid, Args &&... args)
+         {
             if (!entities_.entityActive(entity_uid))
             {
                std::cout << "addComponent entity uid " << entity_uid << " inactive\n";
@@ -95,60 +211,138 @@ namespace trecs
                return false;
             }
 
+            // The archetype is the only record of tag components, so it's
+            // used to find duplicates for every component type.
             DefaultArchetype old_arch = entities_.getArchetype(entity_uid);
+            if (old_arch.supports(component_sig))
+            {
+               std::cout << "Component type " << typeid(Component_T).name() << " already exists on entity " << entity_uid << "\n";
+               return false;
+            }
+
             DefaultArchetype new_arch = old_arch;
             new_arch.mergeSignature(component_sig);
 
             entities_.setArchetype(entity_uid, new_arch);
             queries_.moveEntity(entity_uid, old_arch, new_arch);
-            components_.addComponent(entity_uid, component);
+            components_.emplaceComponent<Component_T>(
+               entity_uid, std::forward<Args>(args)...
+            );
+            ticks_.markAdded(component_sig, entity_uid);
 
             return true;
          }
 
-         // Attempts to update a component on an active entity UID. If a
-         // component of the same type is already associated with this entity,
-         // then the new component replaces the old component. If the new
-         // component type isn't associated with the entity, then the entity's
-         // signature is updated and the component is assigned to the entity.
-         template <typename Component_T>
-         bool updateComponent(uid_t entity_uid, const Component_T & component)
+         // Adds 'count' entities that each get a copy of every prototype
+         // component. The archetype of the new entities is computed once,
+         // component storage is reserved for the whole batch in one step, and
+         // each query is updated once for the batch. This is called as:
+         //
+         //    auto rocks = allocator.spawn(1000, pos_t{}, vel_t{}, rock_t{});
+         //
+         // Returns the UIDs of the new entities in the order they were
+         // created. Returns an empty list without adding any entities if a
+         // component type isn't registered or is repeated, or if there isn't
+         // room for 'count' more entities.
+         template <typename...ComponentTypes>
+         std::vector<uid_t> spawn(
+            size_t count, const ComponentTypes &... prototypes
+         )
          {
-            Component_T * old_component = components_.getComponent<Component_T>(entity_uid);
+            static_assert(
+               sizeof...(ComponentTypes) > 0,
+               "Spawning needs at least one component type"
+            );
 
-            // This is just as good as checking if an entity's current
-            // archetype supports a component signature. If the component
-            // attached to the entity is null, then that component hasn't been
-            // added to the entity, and the entity's archetype does't support
-            // the component's signature.
-            if (old_component != nullptr)
+            DefaultArchetype arch;
+            std::vector<uid_t> entities;
+            if (!spawnEntities<ComponentTypes...>(count, arch, entities))
             {
-               *old_component = component;
-               return true;
+               return entities;
             }
 
-            signature_t component_sig = components_.getSignature<Component_T>();
-            if (component_sig == error_signature)
+            const Span<const uid_t> uids(entities.data(), entities.size());
+            const bool added[] = {
+               components_.addComponents<ComponentTypes>(uids, prototypes)...
+            };
+            (void)added;
+
+            ticks_.markAdded(entities, arch);
+            queries_.addEntities(entities, arch);
+
+            return entities;
+         }
+
+         // Adds one entity per element of the component spans, where entity
+         // 'i' gets element 'i' of every span. All of the spans must be the
+         // same length. Follows the same rules as spawning copies of
+         // prototype components.
+         //
+         //    std::vector<pos_t> positions = ...;
+         //    std::vector<vel_t> velocities = ...;
+         //    auto rocks = allocator.spawn(
+         //       trecs::Span<const pos_t>(positions.data(), positions.size()),
+         //       trecs::Span<const vel_t>(velocities.data(), velocities.size())
+         //    );
+         template <typename...ComponentTypes>
+         std::vector<uid_t> spawn(Span<const ComponentTypes>... components)
+         {
+            static_assert(
+               sizeof...(ComponentTypes) > 0,
+               "Spawning needs at least one component type"
+            );
+
+            const size_t counts[] = {components.size()...};
+            for (const auto count : counts)
             {
-               std::cout << "Couldn't add component to entity UID: " << entity_uid << "\n";
-               std::cout << "\tComponent type " << typeid(Component_T).name() << " isn't registered\n";
-               return false;
+               if (count != counts[0])
+               {
+                  std::cout << "Couldn't spawn entities from component spans of different lengths\n";
+                  return std::vector<uid_t>();
+               }
             }
-            else if (!entities_.entityActive(entity_uid))
+
+            DefaultArchetype arch;
+            std::vector<uid_t> entities;
+            if (!spawnEntities<ComponentTypes...>(counts[0], arch, entities))
             {
-               std::cout << "updateComponent entity uid " << entity_uid << " inactive\n";
-               return false;
+               return entities;
             }
 
-            DefaultArchetype old_arch = entities_.getArchetype(entity_uid);
-            DefaultArchetype new_arch = old_arch;
-            new_arch.mergeSignature(component_sig);
+            const Span<const uid_t> uids(entities.data(), entities.size());
+            const bool added[] = {
+               components_.addComponents<ComponentTypes>(uids, components)...
+            };
+            (void)added;
 
-            entities_.setArchetype(entity_uid, new_arch);
-            queries_.moveEntity(entity_uid, old_arch, new_arch);
-            components_.addComponent(entity_uid, component);
+            ticks_.markAdded(entities, arch);
+            queries_.addEntities(entities, arch);
 
-            return true;
+            return entities;
+         }
+
+         // Attempts to update a component on an active entity UID. If a
+         // component of the same type is already associated with this entity,
+         // then the new component replaces the old component. If the new
+         // component type isn't associated with the entity, then the entity's
+         // signature is updated and the component is assigned to the entity.
+         template <typename Component_T>
+         bool updateComponent(uid_t entity_uid, const Component_T & component)
+         {
+            return assignComponent<Component_T>(entity_uid, component);
+         }
+
+         // Attempts to update a component on an active entity UID by moving
+         // the new component into place. Follows the same rules as updating
+         // a component by const reference.
+         template <typename Component_T>
+         typename std::enable_if<
+            !std::is_lvalue_reference<Component_T>::value, bool
+         >::type updateComponent(uid_t entity_uid, Component_T && component)
+         {
+            return assignComponent<Component_T>(
+               entity_uid, std::move(component)
+            );
          }
 
          // Attempt to retrieve a component of a particular type from an
@@ -202,6 +396,30 @@ namespace trecs
             return components_.getComponents<Component_T>();
          }
 
+         // Returns the float columns of a component type that specializes
+         // 'SoaTraits'. Structure-of-arrays components can't be retrieved by
+         // pointer, use 'readComponent' and 'updateComponent' to access one
+         // entity's component.
+         template <typename Component_T>
+         SoaView<Component_T> getSoaComponents(void)
+         {
+            return components_.getSoaComponents<Component_T>();
+         }
+
+         // Copies a component of a particular type from an entity into
+         // 'component'. Works for every component type. Returns false if the
+         // entity is inactive or doesn't have the component.
+         template <typename Component_T>
+         bool readComponent(uid_t entity_uid, Component_T & component) const
+         {
+            if (!hasComponent<Component_T>(entity_uid))
+            {
+               return false;
+            }
+
+            return components_.readComponent<Component_T>(entity_uid, component);
+         }
+
          template <typename Component_T>
          bool hasComponent(uid_t entity_uid) const
          {
@@ -250,6 +468,10 @@ namespace trecs
             queries_.moveEntity(entity_uid, old_arch, new_arch);
          }
 
+         // Registers a component type with the allocator. Empty component
+         // types are registered as tags, which only occupy a bit in entity
+         // archetypes. Tags can be added, removed, queried, and checked with
+         // 'hasComponent', but they can't be retrieved by pointer.
          template <typename Component_T>
          void registerComponent(void)
          {
@@ -263,19 +485,21 @@ namespace trecs
          uid_t addEntityComponentBuffer(size_t max_buffer_size)
          {
             uid_t ecb_entity = addEntity();
-            EntityComponentBuffer temp_ecb(max_buffer_size);
+            EntityComponentBuffer temp_ecb(
+               max_buffer_size, components_.memoryResource()
+            );
 
             temp_ecb.registerComponents<ComponentTypes...>();
             temp_ecb.lockRegistration();
 
-            if (!updateComponent(ecb_entity, temp_ecb))
+            // The ECB's pools are moved into the ECB component, so the
+            // temporary ECB doesn't own anything afterwards.
+            if (!updateComponent(ecb_entity, std::move(temp_ecb)))
             {
                std::cout << "Couldn't add ECB as a component\n";
                return -1;
             }
 
-            temp_ecb.release();
-
             return ecb_entity;
          }
 
@@ -295,12 +519,31 @@ namespace trecs
          //
          //    allocator.addArchetypeQuery<int, float, complicatedType>();
          //
-         // with as many registered component types as desired.
+         // with as many registered component types as desired. Wrapping a
+         // type in 'Without' matches entities that don't have that component,
+         // wrapping a type in 'Optional' doesn't change which entities match:
+         //
+         //    allocator.addArchetypeQuery<pos_t, Without<sleeping_t> >();
+         //
+         // 'Changed' and 'Added' terms are required component types that
+         // also filter iteration down to the entities whose components were
+         // written or added since a tick, see 'advanceTick':
+         //
+         //    allocator.addArchetypeQuery<pos_t, Changed<vel_t> >();
+         //
+         // At least one component type has to be required, and no type can
+         // be both required and excluded.
          template <class...Args>
          query_t addArchetypeQuery(void)
          {
             DefaultArchetype arch;
-            fancierGetArchetype<Args...>(arch);
+            DefaultArchetype excluded_arch;
+            DefaultArchetype changed_arch;
+            DefaultArchetype added_arch;
+            const bool added[] = {
+               addQueryTerm<Args>(arch, excluded_arch, changed_arch, added_arch)...
+            };
+            (void)added;
 
             if (arch.empty())
             {
@@ -308,7 +551,15 @@ namespace trecs
                return error_query;
             }
 
-            return queries_.addArchetypeQuery(arch);
+            if (arch.intersects(excluded_arch))
+            {
+               std::cout << "Query requires and excludes the same component type.\n";
+               return error_query;
+            }
+
+            return queries_.addArchetypeQuery(
+               arch, excluded_arch, changed_arch, added_arch
+            );
          }
 
          // Returns an archetype object based on the component types provided.
@@ -333,14 +584,219 @@ namespace trecs
          //    - Runs the initialize method
          void initializeSystems(void);
 
-         // Retrieves an unordered set of entities that match a particular
-         // archetype query. Returns an empty set of entities if an invalid
-         // query is provided.
-         auto getQueryEntities(const query_t arch_query) const -> const std::unordered_set<trecs::uid_t> &
+         // Retrieves a contiguous span of the entities that match a
+         // particular archetype query, including disabled entities. The span
+         // is invalidated by adding or removing entities or components.
+         // Returns an empty span if an invalid query is provided.
+         Span<const trecs::uid_t> getQueryEntities(const query_t arch_query) const
          {
             return queries_.getArchetypeEntities(arch_query);
          }
 
+         // Calls 'function(uid)' for every enabled entity that matches a
+         // particular archetype query. 'getQueryEntities' returns disabled
+         // entities too.
+         template <typename Function_T>
+         void forEachQueryEntity(const query_t arch_query, Function_T function) const
+         {
+            const bool skip_disabled = entities_.numDisabled() > 0;
+
+            for (const auto entity : queries_.getArchetypeEntities(arch_query))
+            {
+               if (!skip_disabled || entities_.entityEnabled(entity))
+               {
+                  function(entity);
+               }
+            }
+         }
+
+         // Calls 'function(uid)' for every enabled entity that matches a
+         // particular archetype query and passes the query's 'Changed' and
+         // 'Added' filters since 'since_tick'.
+         template <typename Function_T>
+         void forEachQueryEntity(
+            const query_t arch_query, const tick_t since_tick, Function_T function
+         ) const
+         {
+            const ChangeFilter filter = changeFilter(arch_query, since_tick);
+
+            forEachQueryEntity(
+               arch_query,
+               [this, &filter, &function](uid_t entity)
+               {
+                  if (filter.passes(ticks_, entity))
+                  {
+                     function(entity);
+                  }
+               }
+            );
+         }
+
+         // Returns the current world tick. Adding a component or writing to
+         // it records the current tick.
+         tick_t changeTick(void) const
+         {
+            return ticks_.tick();
+         }
+
+         // Advances the world tick and returns the new tick. Components
+         // written after this call count as changed since the returned tick.
+         // A system that keeps the returned tick and passes it to 'view' or
+         // 'forEachQueryEntity' on its next update sees everything that was
+         // written in between, but not its own writes:
+         //
+         //    allocator.view<pos_t>(changed_pos_query, last_tick_).each(...);
+         //    last_tick_ = allocator.advanceTick();
+         tick_t advanceTick(void)
+         {
+            return ticks_.advance();
+         }
+
+         // Records a write to an entity's component at the current tick.
+         // Writes through 'getComponent' or 'getComponents' aren't recorded
+         // automatically. Returns false if the entity doesn't have the
+         // component.
+         template <typename Component_T>
+         bool markChanged(uid_t entity_uid)
+         {
+            const signature_t sig = getComponentSignature<Component_T>();
+            if (!entityHasSignature(entity_uid, sig))
+            {
+               return false;
+            }
+
+            ticks_.markChanged(sig, entity_uid);
+            return true;
+         }
+
+         // Returns true if an entity has a component that was added or
+         // written since a tick.
+         template <typename Component_T>
+         bool componentChangedSince(uid_t entity_uid, tick_t since_tick) const
+         {
+            const signature_t sig = getComponentSignature<Component_T>();
+            return (
+               entityHasSignature(entity_uid, sig) &&
+               ticks_.changedSince(sig, entity_uid, since_tick)
+            );
+         }
+
+         // Returns true if an entity has a component that was added since a
+         // tick.
+         template <typename Component_T>
+         bool componentAddedSince(uid_t entity_uid, tick_t since_tick) const
+         {
+            const signature_t sig = getComponentSignature<Component_T>();
+            return (
+               entityHasSignature(entity_uid, sig) &&
+               ticks_.addedSince(sig, entity_uid, since_tick)
+            );
+         }
+
+         // Retrieves the archetype chunks that hold the entities matching a
+         // particular archetype query. Only available if the allocator uses
+         // archetype chunk storage, returns an empty list otherwise. Chunks
+         // include disabled entities, check chunk UIDs with 'entityEnabled'
+         // to skip them. Chunks also include entities excluded by tag or
+         // structure-of-arrays 'Without' terms, see
+         // 'ArchetypeChunkStore::getChunks'.
+         std::vector<ArchetypeChunk *> getQueryChunks(const query_t arch_query) const
+         {
+            return components_.getChunks(
+               queries_.getArchetype(arch_query),
+               queries_.getExcludedArchetype(arch_query)
+            );
+         }
+
+         // Returns a typed view of the entities that match a particular
+         // archetype query. This method is called as:
+         //
+         //    allocator.view<pos_t, vel_t, Optional<acc_t> >(query).each(
+         //       [](uid_t entity, pos_t & pos, vel_t & vel, acc_t * acc) { ... }
+         //    );
+         //
+         // Every component type must be registered, and every type that isn't
+         // optional must be part of the query's archetype. Returns an empty
+         // view otherwise. The query's change filters compare against tick
+         // zero, so they don't skip any entities.
+         template <typename...Terms>
+         QueryView<Terms...> view(const query_t arch_query)
+         {
+            return view<Terms...>(arch_query, 0);
+         }
+
+         // Returns a typed view of the entities that match a particular
+         // archetype query whose components pass the query's 'Changed' and
+         // 'Added' filters since 'since_tick'.
+         template <typename...Terms>
+         QueryView<Terms...> view(const query_t arch_query, const tick_t since_tick)
+         {
+            const signature_t sigs[] = {
+               getComponentSignature<typename QueryTerm<Terms>::component_t>()...
+            };
+
+            const query_term_enum_t terms[] = {
+               QueryTerm<Terms>::term...
+            };
+
+            const DefaultArchetype query_arch = queries_.getArchetype(arch_query);
+
+            for (size_t i = 0; i < sizeof...(Terms); ++i)
+            {
+               if (sigs[i] == error_signature)
+               {
+                  std::cout << "Couldn't view an unregistered component type\n";
+                  return QueryView<Terms...>();
+               }
+
+               if (terms[i] == REQUIRED_TERM && !query_arch.supports(sigs[i]))
+               {
+                  std::cout << "Couldn't view a component type that isn't part of the query's archetype\n";
+                  return QueryView<Terms...>();
+               }
+            }
+
+            return QueryView<Terms...>(
+               queries_.getArchetypeEntities(arch_query),
+               &entities_,
+               &ticks_,
+               changeFilter(arch_query, since_tick),
+               sigs,
+               components_.getComponents<typename QueryTerm<Terms>::component_t>()...
+            );
+         }
+
+         // Sorts the components of one type with a comparison function that
+         // takes two const component references. Returns false if the
+         // component type can't be sorted, see 'ComponentManager::sortPool'.
+         template <typename Component_T, typename Compare_T>
+         bool sortPool(Compare_T compare)
+         {
+            return components_.sortPool<Component_T>(compare);
+         }
+
+         // Reorders the pools of every component type in a query's archetype
+         // so that the query's entities come first, in ascending UID order,
+         // and index 'i' refers to the same entity in all of those pools.
+         // Returns the number of entities at the front of the pools. Pools
+         // have to be sorted again after components are added or removed.
+         //
+         //    E.g. After 'n = sortByQuery(query)', index 'i < n' of the
+         //    pages of 'getComponents<pos_t>()' and 'getComponents<vel_t>()'
+         //    belong to the same entity.
+         size_t sortByQuery(const query_t arch_query);
+
+         // Retrieves the column of components of a particular type from an
+         // archetype chunk. Returns an empty span if the chunk doesn't contain
+         // the component type.
+         template <typename Component_T>
+         Span<Component_T> getChunkComponents(ArchetypeChunk & chunk) const
+         {
+            return chunk.getColumn<Component_T>(
+               getComponentSignature<Component_T>()
+            );
+         }
+
       private:
 
          unsigned int max_num_entities_;
@@ -359,10 +815,185 @@ namespace trecs
 
          QueryManager queries_;
 
+         ChangeTicks ticks_;
+
          // Removes `entity_uid` from all of the `trecs::edge_t` components on
          // the edge entities.
          void removeNodeEntityFromEdge(uid_t entity_uid);
 
+         // Removes every entity in 'entity_uids' from all of the
+         // `trecs::edge_t` components on the edge entities in one pass.
+         void removeNodeEntitiesFromEdges(
+            const std::unordered_set<uid_t> & entity_uids
+         );
+
+         // Updates an edge's flag after one or both of its node entities
+         // have been removed.
+         static void updateEdgeFlag(edge_t & edge);
+
+         // Assigns or adds a component to an entity, copying or moving the
+         // component depending on the value category of 'component'.
+         template <typename Component_T, typename Arg_T>
+         bool assignComponent(uid_t entity_uid, Arg_T && component)
+         {
+            // This is just as good as checking if an entity's current
+            // archetype supports a component signature. If there's no
+            // component of this type attached to the entity, then the
+            // entity's archetype doesn't support the component's signature.
+            signature_t component_sig = components_.getSignature<Component_T>();
+
+            if (
+               components_.assignComponent<Component_T>(
+                  entity_uid, std::forward<Arg_T>(component)
+               )
+            )
+            {
+               ticks_.markChanged(component_sig, entity_uid);
+               return true;
+            }
+
+            if (component_sig == error_signature)
+            {
+               std::cout << "Couldn't add component to entity UID: " << entity_uid << "\n";
+               std::cout << "\tComponent type " << typeid(Component_T).name() << " isn't registered\n";
+               return false;
+            }
+            else if (!entities_.entityActive(entity_uid))
+            {
+               std::cout << "updateComponent entity uid " << entity_uid << " inactive\n";
+               return false;
+            }
+
+            DefaultArchetype old_arch = entities_.getArchetype(entity_uid);
+
+            // Tags don't have any data to assign.
+            if (old_arch.supports(component_sig))
+            {
+               return true;
+            }
+
+            DefaultArchetype new_arch = old_arch;
+            new_arch.mergeSignature(component_sig);
+
+            entities_.setArchetype(entity_uid, new_arch);
+            queries_.moveEntity(entity_uid, old_arch, new_arch);
+            components_.emplaceComponent<Component_T>(
+               entity_uid, std::forward<Arg_T>(component)
+            );
+            ticks_.markAdded(component_sig, entity_uid);
+
+            return true;
+         }
+
+         // Adds 'count' entities with the archetype of the component types
+         // and places them in component storage. Their components still have
+         // to be added, and they still have to be added to the queries.
+         // Returns false without adding any entities if any of the types
+         // isn't registered or is repeated, or if there isn't enough room.
+         template <typename...ComponentTypes>
+         bool spawnEntities(
+            size_t count,
+            DefaultArchetype & arch,
+            std::vector<uid_t> & entities
+         )
+         {
+            const signature_t sigs[] = {
+               getComponentSignature<ComponentTypes>()...
+            };
+
+            for (const auto sig : sigs)
+            {
+               if (sig == error_signature)
+               {
+                  std::cout << "Couldn't spawn entities with an unregistered component type\n";
+                  return false;
+               }
+
+               if (arch.supports(sig))
+               {
+                  std::cout << "Couldn't spawn entities with a repeated component type\n";
+                  return false;
+               }
+
+               arch.mergeSignature(sig);
+            }
+
+            if (count > entities_.numAvailable())
+            {
+               std::cout << "Couldn't spawn " << count << " entities, only " << entities_.numAvailable() << " are available\n";
+               return false;
+            }
+
+            entities.reserve(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+               const uid_t entity = entities_.addEntity();
+               entities_.setArchetype(entity, arch);
+               entities.push_back(entity);
+            }
+
+            components_.placeEntities(
+               Span<const uid_t>(entities.data(), entities.size()), arch
+            );
+
+            return true;
+         }
+
+         ChangeFilter changeFilter(const query_t arch_query, const tick_t since_tick) const
+         {
+            return ChangeFilter(
+               since_tick,
+               queries_.getChangedArchetype(arch_query),
+               queries_.getAddedArchetype(arch_query)
+            );
+         }
+
+         bool entityHasSignature(uid_t entity_uid, signature_t sig) const
+         {
+            return (
+               (sig != error_signature) &&
+               entities_.entityActive(entity_uid) &&
+               entities_.getArchetype(entity_uid).supports(sig)
+            );
+         }
+
+         // Merges the signature of one query term into the query's
+         // archetypes. Optional terms don't change any of them.
+         template <class Term_T>
+         bool addQueryTerm(
+            DefaultArchetype & arch,
+            DefaultArchetype & excluded_arch,
+            DefaultArchetype & changed_arch,
+            DefaultArchetype & added_arch
+         ) const
+         {
+            const signature_t sig = getComponentSignature<
+               typename QueryTerm<Term_T>::component_t
+            >();
+
+            switch (QueryTerm<Term_T>::term)
+            {
+               case REQUIRED_TERM:
+                  arch.mergeSignature(sig);
+                  break;
+               case EXCLUDED_TERM:
+                  excluded_arch.mergeSignature(sig);
+                  break;
+               case OPTIONAL_TERM:
+                  break;
+               case CHANGED_TERM:
+                  arch.mergeSignature(sig);
+                  changed_arch.mergeSignature(sig);
+                  break;
+               case ADDED_TERM:
+                  arch.mergeSignature(sig);
+                  added_arch.mergeSignature(sig);
+                  break;
+            }
+
+            return true;
+         }
+
          template <class T>
          void fancierGetArchetype(DefaultArchetype & arch) const
          {
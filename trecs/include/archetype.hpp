@@ -3,6 +3,7 @@
 
 #include "ecs_types.hpp"
 
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
 
@@ -128,6 +129,21 @@ namespace trecs
             return true;
          }
 
+         // Returns true if the archetype shares at least one component
+         // signature with another archetype, false otherwise.
+         bool intersects(const Archetype<BlockCount> & arch) const
+         {
+            for (int i = 0; i < BlockCount; ++i)
+            {
+               if ((archetypes_[i] & arch.archetypes_[i]) != 0)
+               {
+                  return true;
+               }
+            }
+
+            return false;
+         }
+
          // Returns true if the archetype has zero associated component
          // signatures. Returns false otherwise.
          bool empty(void) const
@@ -180,7 +196,25 @@ namespace trecs
 
    };
 
+   // Hashes archetypes so they can key unordered containers.
+   template <int BlockCount>
+   struct ArchetypeHash
+   {
+      size_t operator()(const Archetype<BlockCount> & arch) const
+      {
+         size_t hash = 0;
+         for (int i = 0; i < BlockCount; ++i)
+         {
+            hash ^= arch.at(i) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+         }
+
+         return hash;
+      }
+   };
+
    typedef Archetype<4> DefaultArchetype;
+
+   typedef ArchetypeHash<4> DefaultArchetypeHash;
 }
 
 #endif
@@ -0,0 +1,393 @@
+#ifndef ARCHETYPE_CHUNK_STORE_HEADER
+#define ARCHETYPE_CHUNK_STORE_HEADER
+
+#include "archetype.hpp"
+#include "ecs_types.hpp"
+#include "memory_resource.hpp"
+#include "object_ops.hpp"
+#include "paged_sparse_array.hpp"
+#include "span.hpp"
+
+#include <cstddef>
+#include <map>
+#include <new>
+#include <vector>
+
+namespace trecs
+{
+   // The default number of bytes in one archetype chunk.
+   const size_t default_chunk_size_bytes = 16 * 1024;
+
+   // Type-erased operations on the components in one column of an archetype
+   // chunk.
+   typedef struct column_type_s
+   {
+      size_t size;
+      size_t alignment;
+
+      // Default-constructs a component at 'dest'.
+      void (*construct)(void * dest);
+
+      // Move-assigns the component at 'src' to the component at 'dest'. The
+      // source component is destroyed afterwards.
+      void (*move)(void * dest, void * src);
+
+      // Destroys the component at 'dest'.
+      void (*destroy)(void * dest);
+   } column_type_t;
+
+   template <typename Component_T>
+   struct ColumnOps
+   {
+      static void construct(void * dest)
+      {
+         new (dest) Component_T();
+      }
+
+      static void move(void * dest, void * src)
+      {
+         ObjectOps<Component_T>::moveAssign(
+            static_cast<Component_T *>(dest), static_cast<Component_T *>(src)
+         );
+      }
+
+      static void destroy(void * dest)
+      {
+         ObjectOps<Component_T>::destroy(static_cast<Component_T *>(dest), 1);
+      }
+
+      static column_type_t columnType(void)
+      {
+         column_type_t column_type;
+         column_type.size = sizeof(Component_T);
+         column_type.alignment = alignof(Component_T);
+         column_type.construct = &ColumnOps<Component_T>::construct;
+         column_type.move = &ColumnOps<Component_T>::move;
+         column_type.destroy = &ColumnOps<Component_T>::destroy;
+         return column_type;
+      }
+   };
+
+   class ArchetypeTable;
+
+   // A fixed-size block of memory that holds the components of up to
+   // 'capacity()' entities that all have the same archetype. The block starts
+   // with a column of entity UIDs, followed by one column per component type
+   // in the archetype.
+   class ArchetypeChunk
+   {
+      public:
+         ArchetypeChunk(const ArchetypeTable & table);
+
+         ~ArchetypeChunk(void);
+
+         const DefaultArchetype & archetype(void) const;
+
+         // The number of entities in this chunk.
+         size_t size(void) const
+         {
+            return size_;
+         }
+
+         size_t capacity(void) const;
+
+         // The UIDs of the entities in this chunk. The entity at index 'i'
+         // owns the component at index 'i' of every column.
+         Span<const uid_t> uids(void) const
+         {
+            return Span<const uid_t>(reinterpret_cast<const uid_t *>(bytes_), size_);
+         }
+
+         // Returns a pointer to the first component in the column for a
+         // component signature, or nullptr if the chunk's archetype doesn't
+         // contain the signature.
+         void * column(signature_t sig);
+
+         const void * column(signature_t sig) const;
+
+         // Returns the components in a column as a span, or an empty span if
+         // the chunk's archetype doesn't contain the signature.
+         template <typename Component_T>
+         Span<Component_T> getColumn(signature_t sig)
+         {
+            Component_T * data = static_cast<Component_T *>(column(sig));
+            if (data == nullptr)
+            {
+               return Span<Component_T>();
+            }
+
+            return Span<Component_T>(data, size_);
+         }
+
+      private:
+
+         friend class ArchetypeTable;
+
+         const ArchetypeTable & table_;
+
+         size_t size_;
+
+         // The aligned start of the chunk.
+         unsigned char * bytes_;
+
+         uid_t * uidAt(size_t row)
+         {
+            return reinterpret_cast<uid_t *>(bytes_) + row;
+         }
+
+         void * componentAt(size_t column_offset, size_t component_size, size_t row)
+         {
+            return bytes_ + column_offset + row * component_size;
+         }
+
+         ArchetypeChunk(void);
+
+         ArchetypeChunk(const ArchetypeChunk &);
+
+         ArchetypeChunk & operator=(const ArchetypeChunk &);
+   };
+
+   // Stores all of the entities with one particular archetype as a list of
+   // chunks. Every chunk except the last one is full.
+   class ArchetypeTable
+   {
+      public:
+         ArchetypeTable(
+            const DefaultArchetype & arch,
+            const column_type_t * column_types,
+            size_t chunk_size_bytes,
+            IMemoryResource * resource
+         );
+
+         ~ArchetypeTable(void);
+
+         const DefaultArchetype & archetype(void) const
+         {
+            return archetype_;
+         }
+
+         // The total number of entities in the table.
+         size_t size(void) const
+         {
+            return size_;
+         }
+
+         size_t rowsPerChunk(void) const
+         {
+            return rows_per_chunk_;
+         }
+
+         size_t chunkSizeBytes(void) const
+         {
+            return chunk_size_bytes_;
+         }
+
+         size_t alignment(void) const
+         {
+            return alignment_;
+         }
+
+         const std::vector<ArchetypeChunk *> & chunks(void) const
+         {
+            return chunks_;
+         }
+
+         // Returns true if the table has a column for the signature.
+         bool hasColumn(signature_t sig) const
+         {
+            return column_offsets_[sig] != invalid_offset_;
+         }
+
+         // Appends a row for an entity and default-constructs all of its
+         // components. Returns the index of the new row.
+         size_t appendRow(uid_t entity);
+
+         // Moves the components of the table's last row into 'row' and
+         // destroys the last row. Returns the UID of the entity that was moved
+         // into 'row', or -1 if 'row' was the last row.
+         uid_t removeRow(size_t row);
+
+         // Moves all of the components in 'src_row' of 'src_table' that are
+         // also in this table into 'dest_row' of this table.
+         void moveRowFrom(ArchetypeTable & src_table, size_t src_row, size_t dest_row);
+
+         // Returns a pointer to a component in a row, or nullptr if the table
+         // doesn't have a column for the signature.
+         void * component(size_t row, signature_t sig);
+
+         const void * component(size_t row, signature_t sig) const;
+
+      private:
+
+         friend class ArchetypeChunk;
+
+         static const size_t invalid_offset_ = static_cast<size_t>(-1);
+
+         DefaultArchetype archetype_;
+
+         // The signatures of the components in this table's archetype.
+         std::vector<signature_t> signatures_;
+
+         // Per-signature column type information, owned by the chunk store.
+         const column_type_t * column_types_;
+
+         // The source of memory for chunks, owned by the chunk store's user.
+         IMemoryResource * resource_;
+
+         // Byte offset of each signature's column from the start of a chunk.
+         size_t column_offsets_[max_num_signatures];
+
+         size_t chunk_size_bytes_;
+
+         size_t alignment_;
+
+         size_t rows_per_chunk_;
+
+         size_t size_;
+
+         std::vector<ArchetypeChunk *> chunks_;
+
+         // Calculates the column offsets for a chunk that holds 'num_rows'
+         // entities. Returns the number of bytes needed by the chunk.
+         size_t layoutColumns(size_t num_rows);
+
+         ArchetypeTable(void);
+
+         ArchetypeTable(const ArchetypeTable &);
+
+         ArchetypeTable & operator=(const ArchetypeTable &);
+   };
+
+   // Groups entities with identical archetypes into tables of fixed-size
+   // chunks with one column per component type. Components of entities with
+   // the same archetype are contiguous, so queries can be iterated chunk by
+   // chunk. Adding or removing a component moves the entity's components to
+   // the table for its new archetype.
+   class ArchetypeChunkStore
+   {
+      public:
+         ArchetypeChunkStore(void);
+
+         ArchetypeChunkStore(size_t chunk_size_bytes);
+
+         // Allocates chunks from a memory resource. The resource must outlive
+         // the chunk store.
+         ArchetypeChunkStore(size_t chunk_size_bytes, IMemoryResource * resource);
+
+         ~ArchetypeChunkStore(void);
+
+         // Registers the column type for a component signature.
+         template <typename Component_T>
+         void registerComponent(signature_t sig)
+         {
+            if (sig >= max_num_signatures)
+            {
+               return;
+            }
+
+            column_types_[sig] = ColumnOps<Component_T>::columnType();
+            registered_[sig] = true;
+         }
+
+         // Adds a component to an entity and moves the entity to the table
+         // for its new archetype. Returns a pointer to the default-constructed
+         // component, or nullptr if the signature isn't registered or if the
+         // entity already has the component.
+         void * addComponent(uid_t entity, signature_t sig);
+
+         // Appends rows for entities that aren't stored yet to the table for
+         // 'arch', so that all of their default-constructed components can be
+         // assigned without moving the entities between tables. Signatures
+         // without a registered column are left out of the table. Returns
+         // false without adding anything if any entity is already stored. The
+         // entities must be distinct.
+         bool addEntities(Span<const uid_t> entities, const DefaultArchetype & arch);
+
+         // Removes a component from an entity and moves the entity to the
+         // table for its new archetype.
+         void removeComponent(uid_t entity, signature_t sig);
+
+         // Removes all of an entity's components.
+         void removeComponents(uid_t entity);
+
+         // Returns a pointer to an entity's component, or nullptr if the
+         // entity doesn't have the component.
+         void * getComponent(uid_t entity, signature_t sig);
+
+         const void * getComponent(uid_t entity, signature_t sig) const;
+
+         // Returns the number of entities that have a component.
+         size_t numComponents(signature_t sig) const;
+
+         // Returns the UIDs of all entities that have a component.
+         std::vector<uid_t> getComponentEntities(signature_t sig) const;
+
+         // Returns all of the chunks whose archetypes satisfy an archetype
+         // query.
+         std::vector<ArchetypeChunk *> getChunks(const DefaultArchetype & query_arch) const;
+
+         // Returns all of the chunks whose archetypes satisfy an archetype
+         // query and don't have any of the excluded signatures. Only object
+         // component signatures are part of chunk archetypes, so excluded tag
+         // and structure-of-arrays signatures don't filter out any chunks.
+         std::vector<ArchetypeChunk *> getChunks(
+            const DefaultArchetype & query_arch,
+            const DefaultArchetype & excluded_arch
+         ) const;
+
+         // Returns the number of distinct archetype tables.
+         size_t numTables(void) const
+         {
+            return tables_.size();
+         }
+
+         size_t chunkSizeBytes(void) const
+         {
+            return chunk_size_bytes_;
+         }
+
+         // Destroys all components and frees all chunks.
+         void clear(void);
+
+      private:
+
+         typedef struct entity_location_s
+         {
+            int64_t table;
+            size_t row;
+         } entity_location_t;
+
+         size_t chunk_size_bytes_;
+
+         IMemoryResource * resource_;
+
+         column_type_t column_types_[max_num_signatures];
+
+         bool registered_[max_num_signatures];
+
+         std::vector<ArchetypeTable *> tables_;
+
+         std::map<DefaultArchetype, size_t> archetypes_to_tables_;
+
+         PagedSparseArray<entity_location_t> locations_;
+
+         void initialize(void);
+
+         size_t getOrCreateTable(const DefaultArchetype & arch);
+
+         // Moves an entity from its current table to the table for a new
+         // archetype. Entities with empty archetypes aren't stored in any
+         // table.
+         void moveEntity(uid_t entity, const DefaultArchetype & new_arch);
+
+         // Removes an entity's row from a table and fixes up the location of
+         // the entity that was moved into the removed row.
+         void removeRow(size_t table_index, size_t row);
+
+         ArchetypeChunkStore(const ArchetypeChunkStore &);
+
+         ArchetypeChunkStore & operator=(const ArchetypeChunkStore &);
+   };
+}
+
+#endif
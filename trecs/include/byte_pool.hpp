@@ -2,12 +2,14 @@
 #define BYTE_POOL_HEADER
 
 #include "data_pool_interface.hpp"
+#include "object_ops.hpp"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
 #include <map>
+#include <type_traits>
 #include <vector>
 
 #include <iostream>
@@ -85,12 +87,14 @@ namespace trecs
             }
 
             uid_pool_ = other.uid_pool_;
+            uids_ = other.uids_;
+            last_free_index_ = (
+               (other.last_free_index_ - other.index_offset_) + index_offset_
+            );
 
-            for (const auto uid_to_index : uid_to_index_)
-            {
-               T & component = getComponentFromIndex(uid_to_index.second);
-               component = other.getComponentFromIndex(other.uid_to_index_.at(uid_to_index.first));
-            }
+            copyComponentsFrom(
+               other, typename ObjectOps<T>::trivially_copyable_t()
+            );
 
             return *this;
          }
@@ -120,10 +124,11 @@ namespace trecs
          // UIDs and resets the UID pool to contain all possible UIDs.
          void clear(void) override
          {
-            for (size_t i = 0; i < max_num_bytes_; ++i)
-            {
-               data_pool_[i] = 0;
-            }
+            // Bytes past the last free index are always zero, so only the
+            // bytes of active components need to be cleared.
+            std::memset(
+               data_pool_ + index_offset_, 0, last_free_index_ - index_offset_
+            );
 
             last_free_index_ = index_offset_;
             uid_to_index_.clear();
@@ -197,7 +202,10 @@ namespace trecs
             size_t removed_index = uid_to_index_[uid_to_remove];
             T & removed_component = getComponentFromIndex(removed_index);
             T & last_component = getComponentFromIndex(last_free_index_ - index_increment_);
-            removed_component = last_component;
+            if (&removed_component != &last_component)
+            {
+               ObjectOps<T>::moveAssign(&removed_component, &last_component);
+            }
 
             // Update the index that the last component's UID maps to.
             uid_to_index_[uid_to_update] = removed_index;
@@ -214,10 +222,7 @@ namespace trecs
 
             // Zero out the bytes from the component that was moved to the
             // deleted component's index.
-            for (size_t i = 0; i < index_increment_; ++i)
-            {
-               data_pool_[last_free_index_ + i] = 0;
-            }
+            std::memset(data_pool_ + last_free_index_, 0, index_increment_);
          }
 
          // Returns a container of all of the active UIDs in the pool.
@@ -302,10 +307,7 @@ namespace trecs
 
             last_free_index_ = index_offset_;
 
-            for (size_t i = 0; i < max_num_bytes_; ++i)
-            {
-               data_pool_[i] = 0;
-            }
+            std::memset(data_pool_, 0, max_num_bytes_);
 
             for (uid_t i = 0; i < static_cast<uid_t>(max_num_elements_); ++i)
             {
@@ -313,6 +315,26 @@ namespace trecs
             }
          }
 
+         // Components are packed contiguously from the index offset, so a
+         // trivially copyable pool's active bytes are copied in one block.
+         void copyComponentsFrom(const BytePool<T> & other, std::true_type)
+         {
+            std::memcpy(
+               data_pool_ + index_offset_,
+               other.data_pool_ + other.index_offset_,
+               other.last_free_index_ - other.index_offset_
+            );
+         }
+
+         void copyComponentsFrom(const BytePool<T> & other, std::false_type)
+         {
+            for (const auto uid_to_index : uid_to_index_)
+            {
+               T & component = getComponentFromIndex(uid_to_index.second);
+               component = other.getComponentFromIndex(other.uid_to_index_.at(uid_to_index.first));
+            }
+         }
+
          // Given a byte-level index, retrieves the element of the underlying
          // data structure at that index, and casts the pointer to that element
          // to a pointer to the desired type.
@@ -0,0 +1,187 @@
+#ifndef CHANGE_TICKS_HEADER
+#define CHANGE_TICKS_HEADER
+
+#include "archetype.hpp"
+#include "ecs_types.hpp"
+#include "paged_sparse_array.hpp"
+
+#include <vector>
+
+namespace trecs
+{
+   // Records when each component was added and when it was last written,
+   // using a monotonic world tick. Ticks are stored per component signature
+   // and per UID, so they're unaffected by pools or chunks moving components
+   // around.
+   //
+   // A component was added or changed "since" a tick if its recorded tick is
+   // greater than or equal to that tick. Adding a component also counts as
+   // changing it.
+   class ChangeTicks
+   {
+      public:
+         ChangeTicks(void)
+            : tick_(0)
+            , ticks_(max_num_signatures, PagedSparseArray<component_ticks_t>(emptyTicks()))
+         { }
+
+         // Returns the current world tick, which is recorded by every add
+         // and write.
+         tick_t tick(void) const
+         {
+            return tick_;
+         }
+
+         // Advances the world tick and returns the new tick. Components
+         // written after this call are changed since the returned tick.
+         tick_t advance(void)
+         {
+            return ++tick_;
+         }
+
+         // Records that every component in 'arch' was added to every UID in
+         // 'uids'.
+         void markAdded(const std::vector<uid_t> & uids, const DefaultArchetype & arch)
+         {
+            for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+            {
+               if (!arch.supports(sig))
+               {
+                  continue;
+               }
+
+               for (const auto uid : uids)
+               {
+                  markAdded(sig, uid);
+               }
+            }
+         }
+
+         void markAdded(const signature_t sig, const uid_t uid)
+         {
+            if (sig >= max_num_signatures)
+            {
+               return;
+            }
+
+            component_ticks_t & ticks = ticks_[sig].at(uid);
+            ticks.added = tick_;
+            ticks.changed = tick_;
+         }
+
+         void markChanged(const signature_t sig, const uid_t uid)
+         {
+            if (sig >= max_num_signatures)
+            {
+               return;
+            }
+
+            ticks_[sig].at(uid).changed = tick_;
+         }
+
+         bool addedSince(
+            const signature_t sig, const uid_t uid, const tick_t since_tick
+         ) const
+         {
+            return (sig < max_num_signatures) && (ticks_[sig].get(uid).added >= since_tick);
+         }
+
+         bool changedSince(
+            const signature_t sig, const uid_t uid, const tick_t since_tick
+         ) const
+         {
+            return (sig < max_num_signatures) && (ticks_[sig].get(uid).changed >= since_tick);
+         }
+
+      private:
+
+         typedef struct component_ticks_s
+         {
+            tick_t added;
+            tick_t changed;
+         } component_ticks_t;
+
+         tick_t tick_;
+
+         // Component ticks indexed by signature, then by UID.
+         std::vector<PagedSparseArray<component_ticks_t> > ticks_;
+
+         static component_ticks_t emptyTicks(void)
+         {
+            component_ticks_t ticks;
+            ticks.added = 0;
+            ticks.changed = 0;
+            return ticks;
+         }
+   };
+
+   // Decides whether an entity should be visited based on the change ticks
+   // of its components. An entity passes if every component in the changed
+   // archetype was changed since a tick and every component in the added
+   // archetype was added since that tick.
+   class ChangeFilter
+   {
+      public:
+         // A filter that every entity passes.
+         ChangeFilter(void)
+            : since_tick_(0)
+         { }
+
+         ChangeFilter(
+            const tick_t since_tick,
+            const DefaultArchetype & changed_arch,
+            const DefaultArchetype & added_arch
+         )
+            : since_tick_(since_tick)
+         {
+            for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+            {
+               if (changed_arch.supports(sig))
+               {
+                  changed_sigs_.push_back(sig);
+               }
+               if (added_arch.supports(sig))
+               {
+                  added_sigs_.push_back(sig);
+               }
+            }
+         }
+
+         // Returns true if every entity passes the filter.
+         bool empty(void) const
+         {
+            return changed_sigs_.empty() && added_sigs_.empty();
+         }
+
+         bool passes(const ChangeTicks & ticks, const uid_t uid) const
+         {
+            for (const auto sig : changed_sigs_)
+            {
+               if (!ticks.changedSince(sig, uid, since_tick_))
+               {
+                  return false;
+               }
+            }
+
+            for (const auto sig : added_sigs_)
+            {
+               if (!ticks.addedSince(sig, uid, since_tick_))
+               {
+                  return false;
+               }
+            }
+
+            return true;
+         }
+
+      private:
+
+         tick_t since_tick_;
+
+         std::vector<signature_t> changed_sigs_;
+
+         std::vector<signature_t> added_sigs_;
+   };
+}
+
+#endif
@@ -1,26 +1,126 @@
 #ifndef COMPONENT_ARRAY_WRAPPER_HEADER
 #define COMPONENT_ARRAY_WRAPPER_HEADER
 
+#include "archetype_chunk_store.hpp"
 #include "ext_uid_object_pool.hpp"
+#include "span.hpp"
+
+#include <iterator>
 
 namespace trecs
 {
+   // A reference to a component in a dense array along with the UID of the
+   // entity that owns the component.
+   template <typename Component_T>
+   struct UidComponentRef
+   {
+      uid_t uid;
+      Component_T & component;
+   };
+
+   // Iterates over the dense array of UIDs and the paged dense array of
+   // components in an object pool.
+   template <typename Component_T, typename Pool_T>
+   class DenseComponentIterator
+   {
+      public:
+         typedef std::input_iterator_tag iterator_category;
+         typedef UidComponentRef<Component_T> value_type;
+         typedef std::ptrdiff_t difference_type;
+         typedef UidComponentRef<Component_T> * pointer;
+         typedef UidComponentRef<Component_T> reference;
+
+         DenseComponentIterator(const uid_t * uids, Pool_T * pool, size_t index)
+            : uids_(uids)
+            , pool_(pool)
+            , index_(index)
+         { }
+
+         UidComponentRef<Component_T> operator*(void) const
+         {
+            UidComponentRef<Component_T> ref = {
+               uids_[index_], pool_->componentAt(index_)
+            };
+            return ref;
+         }
+
+         DenseComponentIterator<Component_T, Pool_T> & operator++(void)
+         {
+            ++index_;
+            return *this;
+         }
+
+         DenseComponentIterator<Component_T, Pool_T> operator++(int)
+         {
+            DenseComponentIterator<Component_T, Pool_T> temp(*this);
+            ++(*this);
+            return temp;
+         }
+
+         bool operator==(const DenseComponentIterator<Component_T, Pool_T> & other) const
+         {
+            return index_ == other.index_;
+         }
+
+         bool operator!=(const DenseComponentIterator<Component_T, Pool_T> & other) const
+         {
+            return index_ != other.index_;
+         }
+
+      private:
+
+         const uid_t * uids_;
+
+         Pool_T * pool_;
+
+         size_t index_;
+   };
+
    // This is a simple wrapper around an `ExternalUidObjectPool` class that
-   // only allows access to getters based on entity UIDs.
+   // allows access to components by their entity UIDs, or to the dense arrays
+   // of components and entity UIDs. Components are densely packed in
+   // fixed-size pages, so contiguous access is page by page.
+   //
+   // The dense view is invalidated by adding or removing components of the
+   // wrapped type.
+   //
+   // If components are stored in archetype chunks, the wrapper only supports
+   // access by entity UID and the dense view is empty. Components in archetype
+   // chunks should be iterated chunk by chunk instead.
    template <typename Component_T>
    class ComponentArrayWrapper
    {
       public:
+         typedef DenseComponentIterator<
+            Component_T, ExternalUidObjectPool<Component_T>
+         > iterator;
+
+         typedef DenseComponentIterator<
+            const Component_T, const ExternalUidObjectPool<Component_T>
+         > const_iterator;
+
          ComponentArrayWrapper(void)
             : component_array_(nullptr)
+            , chunks_(nullptr)
+            , signature_(error_signature)
          { }
 
          ComponentArrayWrapper(const ComponentArrayWrapper<Component_T> & other)
             : component_array_(other.component_array_)
+            , chunks_(other.chunks_)
+            , signature_(other.signature_)
          { }
 
          ComponentArrayWrapper(ExternalUidObjectPool<Component_T> * pool)
             : component_array_(pool)
+            , chunks_(nullptr)
+            , signature_(error_signature)
+         { }
+
+         ComponentArrayWrapper(ArchetypeChunkStore * chunks, signature_t sig)
+            : component_array_(nullptr)
+            , chunks_(chunks)
+            , signature_(sig)
          { }
 
          ComponentArrayWrapper<Component_T> & operator=(const ComponentArrayWrapper<Component_T> & other) = default;
@@ -28,33 +128,133 @@ namespace trecs
          // Access a component by its entity UID.
          Component_T * operator[](uid_t uid)
          {
-            return component_array_->getComponent(uid);
+            if (component_array_ != nullptr)
+            {
+               return component_array_->getComponent(uid);
+            }
+
+            return chunkComponent(uid);
          }
 
          // Access a component by its entity UID.
          const Component_T * operator[](uid_t uid) const
          {
-            return component_array_->getComponent(uid);
+            if (component_array_ != nullptr)
+            {
+               return component_array_->getComponent(uid);
+            }
+
+            return chunkComponent(uid);
          }
 
          bool empty(void) const
          {
-            return component_array_ == nullptr;
+            return (component_array_ == nullptr) && (chunks_ == nullptr);
          }
 
          const std::vector<uid_t> getUids(void) const
          {
+            if (chunks_ != nullptr)
+            {
+               return chunks_->getComponentEntities(signature_);
+            }
+
             return component_array_->getUids();
          }
 
          size_t size(void) const
          {
+            if (chunks_ != nullptr)
+            {
+               return chunks_->numComponents(signature_);
+            }
+
+            if (component_array_ == nullptr)
+            {
+               return 0;
+            }
+
             return component_array_->size();
          }
 
+         // Returns the number of pages of densely packed components.
+         size_t numPages(void) const
+         {
+            if (component_array_ == nullptr)
+            {
+               return 0;
+            }
+
+            return component_array_->numPages();
+         }
+
+         // Returns the components in one page. The component at index 'i' of
+         // page 'p' is owned by the entity UID at index
+         // 'p * pageSize() + i' of 'uids()'.
+         Span<Component_T> page(size_t page_index)
+         {
+            if (component_array_ == nullptr)
+            {
+               return Span<Component_T>();
+            }
+
+            return component_array_->page(page_index);
+         }
+
+         Span<const Component_T> page(size_t page_index) const
+         {
+            if (component_array_ == nullptr)
+            {
+               return Span<const Component_T>();
+            }
+
+            const ExternalUidObjectPool<Component_T> * pool = component_array_;
+            return pool->page(page_index);
+         }
+
+         // The maximum number of components in one page.
+         static size_t pageSize(void)
+         {
+            return ExternalUidObjectPool<Component_T>::pageSize();
+         }
+
+         // Returns the entity UIDs of the components in the same order as the
+         // components in the pages.
+         Span<const uid_t> uids(void) const
+         {
+            if (component_array_ == nullptr)
+            {
+               return Span<const uid_t>();
+            }
+
+            const std::vector<uid_t> & dense_uids = component_array_->getUids();
+            return Span<const uid_t>(dense_uids.data(), dense_uids.size());
+         }
+
+         // Iterators over (uid, component) pairs in dense order.
+         iterator begin(void)
+         {
+            return iterator(uids().data(), component_array_, 0);
+         }
+
+         iterator end(void)
+         {
+            return iterator(uids().data(), component_array_, uids().size());
+         }
+
+         const_iterator begin(void) const
+         {
+            return const_iterator(uids().data(), component_array_, 0);
+         }
+
+         const_iterator end(void) const
+         {
+            return const_iterator(uids().data(), component_array_, uids().size());
+         }
+
          void print_uids(void) const
          {
-            auto uids = component_array_->getUids();
+            auto uids = getUids();
             std::cout << "available uids\n";
             for (const auto uid : uids)
             {
@@ -66,6 +266,22 @@ namespace trecs
 
          ExternalUidObjectPool<Component_T> * component_array_;
 
+         ArchetypeChunkStore * chunks_;
+
+         signature_t signature_;
+
+         Component_T * chunkComponent(uid_t uid) const
+         {
+            if (chunks_ == nullptr)
+            {
+               return nullptr;
+            }
+
+            return static_cast<Component_T *>(
+               chunks_->getComponent(uid, signature_)
+            );
+         }
+
    };
 }
 
@@ -1,17 +1,58 @@
 #ifndef COMPONENT_MANAGER_HEADER
 #define COMPONENT_MANAGER_HEADER
 
+#include "archetype_chunk_store.hpp"
 #include "component_array_wrapper.hpp"
 #include "data_pool_interface.hpp"
 #include "ext_uid_object_pool.hpp"
+#include "ext_uid_soa_pool.hpp"
+#include "memory_resource.hpp"
 #include "signature_manager.hpp"
 
 #include <iostream>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace trecs
 {
+   // Empty component types carry no data, so they're treated as tags. Tags
+   // have no storage at all; an entity has a tag if and only if its archetype
+   // has the tag's signature bit. Specialize this trait to opt an empty type
+   // out of tag handling.
+   template <typename Component_T>
+   struct IsTagComponent
+      : std::integral_constant<bool, std::is_empty<Component_T>::value>
+   { };
+
+   // How a component manager stores a single component type.
+   //    - OBJECT_COMPONENT: objects in a per-type pool or archetype chunks.
+   //    - SOA_COMPONENT: float columns, see 'SoaTraits'.
+   //    - TAG_COMPONENT: nothing, see 'IsTagComponent'.
+   typedef enum component_kind
+   {
+      OBJECT_COMPONENT = 0,
+      SOA_COMPONENT = 1,
+      TAG_COMPONENT = 2
+   } component_kind_enum_t;
+
+   template <typename Component_T>
+   struct ComponentKind
+      : std::integral_constant<
+         component_kind_enum_t,
+         IsTagComponent<Component_T>::value ? TAG_COMPONENT : (
+            SoaTraits<Component_T>::enabled ? SOA_COMPONENT : OBJECT_COMPONENT
+         )
+      >
+   { };
+
+   typedef std::integral_constant<component_kind_enum_t, OBJECT_COMPONENT> object_component_t;
+
+   typedef std::integral_constant<component_kind_enum_t, SOA_COMPONENT> soa_component_t;
+
+   typedef std::integral_constant<component_kind_enum_t, TAG_COMPONENT> tag_component_t;
+
    // Components are arranged into pools of data based on component type.
    // Two components with different types can be referenced by the same
    // component UID. Two components with the same type cannot be referenced by
@@ -25,14 +66,44 @@ namespace trecs
    //
    // The ComponentManager allocates data but does not automatically free that
    // data on destruction. 
+   //
+   // By default every component type is stored in its own pool. Optionally,
+   // components can be stored in archetype chunks, where entities with the
+   // same archetype share fixed-size chunks of memory with one column per
+   // component type.
+   //
+   // Tag components are registered for a signature but never stored, so
+   // adding or removing one is a no-op here. Whoever tracks entity
+   // archetypes tracks tags.
    class ComponentManager
    {
       public:
          ComponentManager(size_t max_size);
 
+         ComponentManager(size_t max_size, component_storage_enum_t storage);
+
+         // Allocates all component storage from a memory resource. The
+         // resource must outlive the component manager and any component
+         // manager that takes ownership of its pools.
+         ComponentManager(
+            size_t max_size,
+            component_storage_enum_t storage,
+            IMemoryResource * resource
+         );
+
+         // Copies the raw pointers to the source's pools without changing
+         // their ownership, just like the const assignment operator. The
+         // source must be released after the copy.
+         ComponentManager(const ComponentManager & other);
+
+         // Takes ownership of the source's pools.
+         ComponentManager(ComponentManager && other);
+
          ComponentManager & operator=(const ComponentManager & other);
 
          ComponentManager & operator=(ComponentManager & other);
+
+         ComponentManager & operator=(ComponentManager && other);
  
          // Resets all of the data pools back to zero elements. Does not
          // release any data.
@@ -60,14 +131,32 @@ namespace trecs
                return;
             }
 
-            data_pools_[new_sig].reset(
-               new ExternalUidObjectPool<Component_T>(max_size_)
-            );
+            createStorage<Component_T>(new_sig, ComponentKind<Component_T>());
          }
 
          template <typename Component_T>
          ComponentArrayWrapper<Component_T> getComponents(void)
          {
+            static_assert(
+               !IsTagComponent<Component_T>::value,
+               "Tag components have no storage, check the entity's archetype instead"
+            );
+            static_assert(
+               !SoaTraits<Component_T>::enabled,
+               "Structure-of-arrays components are accessed with getSoaComponents"
+            );
+
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               signature_t sig = getSignature<Component_T>();
+               if (sig == error_signature)
+               {
+                  return ComponentArrayWrapper<Component_T>();
+               }
+
+               return ComponentArrayWrapper<Component_T>(chunks_.get(), sig);
+            }
+
             ComponentArrayWrapper<Component_T> wrapper(
                retrievePoolByType<Component_T>()
             );
@@ -82,24 +171,174 @@ namespace trecs
             const Component_T & component
          )
          {
-            ExternalUidObjectPool<Component_T> * pool = \
-               retrievePoolByType<Component_T>();
+            return emplaceComponent<Component_T>(new_component_uid, component);
+         }
+
+         // Attempts to move a component into a particular component UID.
+         // Returns 'new_component_uid' if successful, returns -1 otherwise.
+         template <typename Component_T>
+         typename std::enable_if<
+            !std::is_lvalue_reference<Component_T>::value, uid_t
+         >::type addComponent(
+            uid_t new_component_uid,
+            Component_T && component
+         )
+         {
+            return emplaceComponent<Component_T>(
+               new_component_uid, std::move(component)
+            );
+         }
+
+         // Attempts to construct a component in place at a particular
+         // component UID from a list of constructor arguments. Returns
+         // 'new_component_uid' if successful, returns -1 otherwise.
+         template <typename Component_T, typename...Args>
+         uid_t emplaceComponent(uid_t new_component_uid, Args &&... args)
+         {
+            return emplaceComponent<Component_T>(
+               ComponentKind<Component_T>(),
+               new_component_uid,
+               std::forward<Args>(args)...
+            );
+         }
+
+         // Prepares storage for new entities that are about to be given every
+         // component in 'arch' with 'addComponents'. With archetype chunk
+         // storage the entities are placed in the table for their final
+         // archetype up front, so adding their components doesn't move them
+         // between tables. Returns false if any entity already has components
+         // in archetype chunks.
+         bool placeEntities(Span<const uid_t> entities, const DefaultArchetype & arch);
+
+         // Adds a copy of 'prototype' at every component UID in 'uids'.
+         // Pools reserve room for the whole batch in one step. Returns false
+         // if any UID already has a component of this type, in which case
+         // pools are left unchanged. Entities that were placed in archetype
+         // chunks with 'placeEntities' get their components assigned to the
+         // slots that were made for them.
+         template <typename Component_T>
+         bool addComponents(Span<const uid_t> uids, const Component_T & prototype)
+         {
+            return addComponents<Component_T>(
+               ComponentKind<Component_T>(), uids, prototype
+            );
+         }
+
+         // Adds 'components[i]' at component UID 'uids[i]' for every UID.
+         // Follows the same rules as adding copies of a prototype.
+         template <typename Component_T>
+         bool addComponents(
+            Span<const uid_t> uids, Span<const Component_T> components
+         )
+         {
+            return addComponents<Component_T>(
+               ComponentKind<Component_T>(), uids, components
+            );
+         }
+
+         // Replaces an existing component at a component UID by copying or
+         // moving 'component' into it. Returns false if there is no
+         // component of this type at the UID, which is always the case for
+         // tags.
+         template <typename Component_T, typename Arg_T>
+         bool assignComponent(uid_t component_uid, Arg_T && component)
+         {
+            return assignComponent<Component_T>(
+               ComponentKind<Component_T>(),
+               component_uid,
+               std::forward<Arg_T>(component)
+            );
+         }
+
+         // Copies the component at a component UID into 'component'. Returns
+         // false if there is no component of this type at the UID. Tags have
+         // nothing to copy, so reading one always succeeds.
+         template <typename Component_T>
+         bool readComponent(uid_t component_uid, Component_T & component) const
+         {
+            return readComponent(ComponentKind<Component_T>(), component_uid, component);
+         }
+
+         // Returns true if a component of this type is associated with the
+         // component UID.
+         template <typename Component_T>
+         bool hasComponent(uid_t component_uid) const
+         {
+            static_assert(
+               !IsTagComponent<Component_T>::value,
+               "Tag components have no storage, check the entity's archetype instead"
+            );
+            return hasComponent<Component_T>(ComponentKind<Component_T>(), component_uid);
+         }
 
+         // Returns the float columns of a structure-of-arrays component type.
+         // Returns an empty view if the component type isn't registered.
+         template <typename Component_T>
+         SoaView<Component_T> getSoaComponents(void)
+         {
+            ExternalUidSoaPool<Component_T> * pool = retrieveSoaPool<Component_T>();
             if (pool == nullptr)
             {
-               std::cout << "Couldn't add component\n";
-               return -1;
+               return SoaView<Component_T>();
             }
 
-            uid_t result = pool->addComponent(new_component_uid, component);
+            return pool->view();
+         }
 
-            return result;
+         // Sorts the pool of one component type with a comparison function
+         // that takes two const component references. Sorting changes the
+         // order that components are iterated in, not their UIDs. Returns
+         // false if the component type has no pool, which is the case for
+         // tags and for objects stored in archetype chunks.
+         template <typename Component_T, typename Compare_T>
+         bool sortPool(Compare_T compare)
+         {
+            return sortPool<Component_T>(ComponentKind<Component_T>(), compare);
          }
 
+         // Moves the components of 'entities' to the front of every pool in
+         // the query archetype, in the same order. Afterwards index 'i' of
+         // every one of those pools refers to 'entities[i]', for 'i' less
+         // than the number of entities. Entities must have every component
+         // in the archetype.
+         //
+         // Objects stored in archetype chunks are already kept in lockstep
+         // by their tables, so only structure-of-arrays pools are reordered
+         // with archetype chunk storage.
+         void sortByQuery(
+            const DefaultArchetype & query_arch,
+            const std::vector<uid_t> & entities
+         );
+
          // Removes a particular component type at a particular component UID.
          template <typename Component_T>
          void removeComponent(uid_t removed_component_uid)
          {
+            if (IsTagComponent<Component_T>::value)
+            {
+               return;
+            }
+
+            if (SoaTraits<Component_T>::enabled)
+            {
+               IDataPool * pool = retrieveBasePool<Component_T>();
+               if (pool != nullptr)
+               {
+                  pool->removeComponent(removed_component_uid);
+               }
+               return;
+            }
+
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               signature_t sig = getSignature<Component_T>();
+               if (sig != error_signature)
+               {
+                  chunks_->removeComponent(removed_component_uid, sig);
+               }
+               return;
+            }
+
             ExternalUidObjectPool<Component_T> * pool = \
                retrievePoolByType<Component_T>();
 
@@ -116,21 +355,69 @@ namespace trecs
          // an entity is removed.
          void removeComponents(uid_t removed_components_uid);
 
+         // Removes all of the components of a batch of component UIDs whose
+         // entities share the archetype 'arch'. Only the pools of component
+         // types in the archetype are touched.
+         void removeComponents(
+            Span<const uid_t> removed_components_uids,
+            const DefaultArchetype & arch
+         );
+
          template <typename Component_T>
          Component_T * getComponent(uid_t component_uid)
          {
+            static_assert(
+               !SoaTraits<Component_T>::enabled,
+               "Structure-of-arrays components can't be accessed by pointer"
+            );
+            static_assert(
+               !IsTagComponent<Component_T>::value,
+               "Tag components have no storage, check the entity's archetype instead"
+            );
+
             return retrieveComponentByUid<Component_T>(component_uid);
          }
 
          template <typename Component_T>
          const Component_T * getComponent(uid_t component_uid) const
          {
+            static_assert(
+               !SoaTraits<Component_T>::enabled,
+               "Structure-of-arrays components can't be accessed by pointer"
+            );
+            static_assert(
+               !IsTagComponent<Component_T>::value,
+               "Tag components have no storage, check the entity's archetype instead"
+            );
+
             return retrieveComponentByUid<Component_T>(component_uid);
          }
 
          template <typename Component_T>
          size_t getNumComponents(void) const
          {
+            static_assert(
+               !IsTagComponent<Component_T>::value,
+               "Tag components have no storage, check the entity's archetype instead"
+            );
+
+            if (SoaTraits<Component_T>::enabled)
+            {
+               const IDataPool * pool = retrieveBasePool<Component_T>();
+               return (pool == nullptr) ? 0 : pool->size();
+            }
+
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               signature_t sig = getSignature<Component_T>();
+               if (sig == error_signature)
+               {
+                  return 0;
+               }
+
+               return chunks_->numComponents(sig);
+            }
+
             const auto pool = retrievePoolByType<Component_T>();
             if (pool == nullptr)
             {
@@ -148,31 +435,324 @@ namespace trecs
 
          size_t getNumSignatures(void) const;
 
+         component_storage_enum_t storageMode(void) const
+         {
+            return storage_;
+         }
+
+         IMemoryResource * memoryResource(void) const
+         {
+            return resource_;
+         }
+
+         // Returns all of the archetype chunks that satisfy an archetype query.
+         // Returns an empty list if components aren't stored in archetype
+         // chunks.
+         std::vector<ArchetypeChunk *> getChunks(
+            const DefaultArchetype & query_arch
+         ) const;
+
+         // Returns all of the archetype chunks that satisfy an archetype
+         // query and don't hold any excluded object components. Returns an
+         // empty list if components aren't stored in archetype chunks.
+         std::vector<ArchetypeChunk *> getChunks(
+            const DefaultArchetype & query_arch,
+            const DefaultArchetype & excluded_arch
+         ) const;
+
          template <typename Component_T>
          std::vector<uid_t> getComponentEntities(void) const
          {
-            const auto derived_pool = retrievePoolByType<Component_T>();
-            if (derived_pool == nullptr)
-            {
-               std::cout << "Couldn't find component pool\n";
-               return std::vector<uid_t>();
-            }
+            static_assert(
+               !IsTagComponent<Component_T>::value,
+               "Tag components have no storage, check the entity's archetype instead"
+            );
 
-            return derived_pool->getUids();
+            return getComponentEntities<Component_T>(ComponentKind<Component_T>());
          }
 
       private:
 
          size_t max_size_;
 
-         // This is a mapping of integer signature types to allocators.
+         component_storage_enum_t storage_;
+
+         IMemoryResource * resource_;
+
+         // This is a mapping of integer signature types to allocators. Only
+         // used with per-type pool storage and for structure-of-arrays
+         // components.
          std::vector<std::unique_ptr<IDataPool> > data_pools_;
 
+         // Archetype tables for all components. Only used with archetype chunk
+         // storage.
+         std::unique_ptr<ArchetypeChunkStore> chunks_;
+
          SignatureManager<signature_t> signatures_;
 
+         template <typename Component_T>
+         void createStorage(signature_t sig, soa_component_t)
+         {
+            data_pools_[sig].reset(
+               new ExternalUidSoaPool<Component_T>(max_size_, resource_)
+            );
+         }
+
+         template <typename Component_T>
+         void createStorage(signature_t sig, object_component_t)
+         {
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               chunks_->registerComponent<Component_T>(sig);
+               return;
+            }
+
+            data_pools_[sig].reset(
+               new ExternalUidObjectPool<Component_T>(max_size_, resource_)
+            );
+         }
+
+         template <typename Component_T, typename Compare_T>
+         bool sortPool(tag_component_t, Compare_T)
+         {
+            return false;
+         }
+
+         template <typename Component_T, typename Compare_T>
+         bool sortPool(soa_component_t, Compare_T compare)
+         {
+            ExternalUidSoaPool<Component_T> * pool = retrieveSoaPool<Component_T>();
+            if (pool == nullptr)
+            {
+               return false;
+            }
+
+            pool->sort(compare);
+            return true;
+         }
+
+         template <typename Component_T, typename Compare_T>
+         bool sortPool(object_component_t, Compare_T compare)
+         {
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               std::cout << "Can't sort components stored in archetype chunks\n";
+               return false;
+            }
+
+            ExternalUidObjectPool<Component_T> * pool = \
+               retrievePoolByType<Component_T>();
+
+            if (pool == nullptr)
+            {
+               return false;
+            }
+
+            pool->sort(compare);
+            return true;
+         }
+
+         template <typename Component_T>
+         void createStorage(signature_t, tag_component_t)
+         { }
+
+         template <typename Component_T, typename...Args>
+         uid_t emplaceComponent(
+            tag_component_t, uid_t new_component_uid, Args &&...
+         )
+         {
+            if (getSignature<Component_T>() == error_signature)
+            {
+               std::cout << "Couldn't add component\n";
+               return -1;
+            }
+
+            return new_component_uid;
+         }
+
+         template <typename Component_T, typename...Args>
+         uid_t emplaceComponent(
+            soa_component_t, uid_t new_component_uid, Args &&... args
+         )
+         {
+            ExternalUidSoaPool<Component_T> * pool = retrieveSoaPool<Component_T>();
+            if (pool == nullptr)
+            {
+               std::cout << "Couldn't add component\n";
+               return -1;
+            }
+
+            return pool->emplaceComponent(
+               new_component_uid, std::forward<Args>(args)...
+            );
+         }
+
+         template <typename Component_T, typename...Args>
+         uid_t emplaceComponent(
+            object_component_t, uid_t new_component_uid, Args &&... args
+         )
+         {
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               return addChunkComponent<Component_T>(
+                  new_component_uid, std::forward<Args>(args)...
+               );
+            }
+
+            ExternalUidObjectPool<Component_T> * pool = \
+               retrievePoolByType<Component_T>();
+
+            if (pool == nullptr)
+            {
+               std::cout << "Couldn't add component\n";
+               return -1;
+            }
+
+            uid_t result = pool->emplaceComponent(
+               new_component_uid, std::forward<Args>(args)...
+            );
+
+            return result;
+         }
+
+         // Chunk slots are default-constructed when an entity moves to its
+         // new archetype table, so the new component is move-assigned into
+         // its slot.
+         template <typename Component_T, typename...Args>
+         uid_t addChunkComponent(uid_t new_component_uid, Args &&... args)
+         {
+            signature_t sig = getSignature<Component_T>();
+            if (sig == error_signature)
+            {
+               std::cout << "Couldn't add component\n";
+               return -1;
+            }
+
+            Component_T * new_component = static_cast<Component_T *>(
+               chunks_->addComponent(new_component_uid, sig)
+            );
+
+            if (new_component == nullptr)
+            {
+               return -1;
+            }
+
+            *new_component = Component_T(std::forward<Args>(args)...);
+
+            return new_component_uid;
+         }
+
+         template <typename Component_T, typename Source_T>
+         bool addComponents(tag_component_t, Span<const uid_t>, const Source_T &)
+         {
+            if (getSignature<Component_T>() == error_signature)
+            {
+               std::cout << "Couldn't add components\n";
+               return false;
+            }
+
+            return true;
+         }
+
+         template <typename Component_T, typename Source_T>
+         bool addComponents(
+            soa_component_t, Span<const uid_t> uids, const Source_T & source
+         )
+         {
+            ExternalUidSoaPool<Component_T> * pool = retrieveSoaPool<Component_T>();
+            if (pool == nullptr)
+            {
+               std::cout << "Couldn't add components\n";
+               return false;
+            }
+
+            return pool->addComponents(uids, source);
+         }
+
+         template <typename Component_T, typename Source_T>
+         bool addComponents(
+            object_component_t, Span<const uid_t> uids, const Source_T & source
+         )
+         {
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               return addChunkComponents<Component_T>(uids, source);
+            }
+
+            ExternalUidObjectPool<Component_T> * pool = \
+               retrievePoolByType<Component_T>();
+
+            if (pool == nullptr)
+            {
+               std::cout << "Couldn't add components\n";
+               return false;
+            }
+
+            return pool->addComponents(uids, source);
+         }
+
+         // Assigns components to chunk slots. Entities that were placed in
+         // their final table with 'placeEntities' already have a slot for
+         // the component, any other entity is moved to a new table first.
+         template <typename Component_T, typename Source_T>
+         bool addChunkComponents(Span<const uid_t> uids, const Source_T & source)
+         {
+            signature_t sig = getSignature<Component_T>();
+            if (sig == error_signature)
+            {
+               std::cout << "Couldn't add components\n";
+               return false;
+            }
+
+            for (size_t i = 0; i < uids.size(); ++i)
+            {
+               void * slot = chunks_->getComponent(uids[i], sig);
+               if (slot == nullptr)
+               {
+                  slot = chunks_->addComponent(uids[i], sig);
+               }
+
+               if (slot == nullptr)
+               {
+                  return false;
+               }
+
+               *static_cast<Component_T *>(slot) = sourceAt(source, i);
+            }
+
+            return true;
+         }
+
+         template <typename Component_T>
+         static const Component_T & sourceAt(const Component_T & prototype, size_t)
+         {
+            return prototype;
+         }
+
+         template <typename Component_T>
+         static const Component_T & sourceAt(
+            Span<const Component_T> components, size_t index
+         )
+         {
+            return components[index];
+         }
+
          template <typename Component_T>
          Component_T * retrieveComponentByUid(uid_t component_uid)
          {
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               signature_t sig = getSignature<Component_T>();
+               if (sig == error_signature)
+               {
+                  return nullptr;
+               }
+
+               return static_cast<Component_T *>(
+                  chunks_->getComponent(component_uid, sig)
+               );
+            }
+
             ExternalUidObjectPool<Component_T> * pool_derived = \
                retrievePoolByType<Component_T>();
 
@@ -187,7 +767,21 @@ namespace trecs
          template <typename Component_T>
          const Component_T * retrieveComponentByUid(uid_t component_uid) const
          {
-            ExternalUidObjectPool<Component_T> * pool_derived = \
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               signature_t sig = getSignature<Component_T>();
+               if (sig == error_signature)
+               {
+                  return nullptr;
+               }
+
+               const ArchetypeChunkStore * chunks = chunks_.get();
+               return static_cast<const Component_T *>(
+                  chunks->getComponent(component_uid, sig)
+               );
+            }
+
+            const ExternalUidObjectPool<Component_T> * pool_derived = \
                retrievePoolByType<Component_T>();
 
             if (pool_derived == nullptr)
@@ -245,6 +839,188 @@ namespace trecs
 
             return pool_derived;
          }
+
+         // Returns the type-erased pool for a component type, or null if the
+         // component type doesn't have a pool.
+         template <typename Component_T>
+         IDataPool * retrieveBasePool(void)
+         {
+            signature_t signature = getSignature<Component_T>();
+
+            if (signature >= data_pools_.size())
+            {
+               return nullptr;
+            }
+
+            return data_pools_[signature].get();
+         }
+
+         template <typename Component_T>
+         const IDataPool * retrieveBasePool(void) const
+         {
+            signature_t signature = getSignature<Component_T>();
+
+            if (signature >= data_pools_.size())
+            {
+               return nullptr;
+            }
+
+            return data_pools_[signature].get();
+         }
+
+         template <typename Component_T>
+         ExternalUidSoaPool<Component_T> * retrieveSoaPool(void)
+         {
+            return static_cast<ExternalUidSoaPool<Component_T> *>(
+               retrieveBasePool<Component_T>()
+            );
+         }
+
+         template <typename Component_T>
+         const ExternalUidSoaPool<Component_T> * retrieveSoaPool(void) const
+         {
+            return static_cast<const ExternalUidSoaPool<Component_T> *>(
+               retrieveBasePool<Component_T>()
+            );
+         }
+
+         template <typename Component_T, typename Arg_T>
+         bool assignComponent(tag_component_t, uid_t, Arg_T &&)
+         {
+            return false;
+         }
+
+         template <typename Component_T, typename Arg_T>
+         bool assignComponent(
+            soa_component_t, uid_t component_uid, Arg_T && component
+         )
+         {
+            ExternalUidSoaPool<Component_T> * pool = retrieveSoaPool<Component_T>();
+
+            return (pool != nullptr) && pool->writeComponent(component_uid, component);
+         }
+
+         template <typename Component_T, typename Arg_T>
+         bool assignComponent(
+            object_component_t, uid_t component_uid, Arg_T && component
+         )
+         {
+            Component_T * existing = retrieveComponentByUid<Component_T>(
+               component_uid
+            );
+
+            if (existing == nullptr)
+            {
+               return false;
+            }
+
+            *existing = std::forward<Arg_T>(component);
+
+            return true;
+         }
+
+         template <typename Component_T>
+         bool readComponent(tag_component_t, uid_t, Component_T &) const
+         {
+            return true;
+         }
+
+         template <typename Component_T>
+         bool readComponent(
+            soa_component_t, uid_t component_uid, Component_T & component
+         ) const
+         {
+            const ExternalUidSoaPool<Component_T> * pool = \
+               retrieveSoaPool<Component_T>();
+
+            return (pool != nullptr) && pool->readComponent(component_uid, component);
+         }
+
+         template <typename Component_T>
+         bool readComponent(
+            object_component_t, uid_t component_uid, Component_T & component
+         ) const
+         {
+            const Component_T * existing = retrieveComponentByUid<Component_T>(
+               component_uid
+            );
+
+            if (existing == nullptr)
+            {
+               return false;
+            }
+
+            component = *existing;
+
+            return true;
+         }
+
+         template <typename Component_T>
+         bool hasComponent(tag_component_t, uid_t) const
+         {
+            return false;
+         }
+
+         template <typename Component_T>
+         bool hasComponent(soa_component_t, uid_t component_uid) const
+         {
+            const ExternalUidSoaPool<Component_T> * pool = \
+               retrieveSoaPool<Component_T>();
+
+            return (pool != nullptr) && pool->hasComponent(component_uid);
+         }
+
+         template <typename Component_T>
+         bool hasComponent(object_component_t, uid_t component_uid) const
+         {
+            return retrieveComponentByUid<Component_T>(component_uid) != nullptr;
+         }
+
+         template <typename Component_T>
+         std::vector<uid_t> getComponentEntities(tag_component_t) const
+         {
+            return std::vector<uid_t>();
+         }
+
+         template <typename Component_T>
+         std::vector<uid_t> getComponentEntities(soa_component_t) const
+         {
+            const ExternalUidSoaPool<Component_T> * pool = \
+               retrieveSoaPool<Component_T>();
+
+            if (pool == nullptr)
+            {
+               std::cout << "Couldn't find component pool\n";
+               return std::vector<uid_t>();
+            }
+
+            return pool->getUids();
+         }
+
+         template <typename Component_T>
+         std::vector<uid_t> getComponentEntities(object_component_t) const
+         {
+            if (storage_ == ARCHETYPE_CHUNKS)
+            {
+               signature_t sig = getSignature<Component_T>();
+               if (sig == error_signature)
+               {
+                  std::cout << "Couldn't find component pool\n";
+                  return std::vector<uid_t>();
+               }
+
+               return chunks_->getComponentEntities(sig);
+            }
+
+            const auto derived_pool = retrievePoolByType<Component_T>();
+            if (derived_pool == nullptr)
+            {
+               std::cout << "Couldn't find component pool\n";
+               return std::vector<uid_t>();
+            }
+
+            return derived_pool->getUids();
+         }
    };
 }
 
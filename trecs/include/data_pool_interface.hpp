@@ -4,6 +4,7 @@
 #include "ecs_types.hpp"
 
 #include <cstring>
+#include <vector>
 
 namespace trecs
 {
@@ -23,6 +24,15 @@ namespace trecs
          virtual size_t size(void) const = 0;
 
          virtual void clear(void) = 0;
+
+         // Moves the components at 'front_uids' to the front of the pool in
+         // the given order. All other components keep their relative order
+         // behind them. UIDs that aren't in the pool are skipped. Pools
+         // without a dense component order ignore this.
+         virtual void reorder(const std::vector<uid_t> & front_uids)
+         {
+            (void)front_uids;
+         }
    };
 
 }
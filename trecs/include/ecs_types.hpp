@@ -17,6 +17,75 @@ namespace trecs
 
    const auto error_signature = 128 - 1;
 
+   // A point in the history of component changes, see 'ChangeTicks'.
+   typedef uint64_t tick_t;
+
+   // Determines how a component manager lays out component data.
+   //    - PER_TYPE_POOLS: every component type is stored in its own pool.
+   //    - ARCHETYPE_CHUNKS: entities with identical archetypes are stored
+   //      together in fixed-size chunks with one column per component type.
+   typedef enum component_storage
+   {
+      PER_TYPE_POOLS = 0,
+      ARCHETYPE_CHUNKS = 1
+   } component_storage_enum_t;
+
+   // A weak reference to an entity. Packs an entity UID into the low 32
+   // bits and the generation of the UID's slot into the high 32 bits. A
+   // slot's generation changes every time its entity is removed, so a
+   // handle to a removed entity never refers to a new entity that reuses
+   // the UID.
+   typedef struct entity_handle_s
+   {
+      uint64_t bits;
+
+      uid_t uid(void) const
+      {
+         return static_cast<uid_t>(bits & 0xffffffffu);
+      }
+
+      uint32_t generation(void) const
+      {
+         return static_cast<uint32_t>(bits >> 32);
+      }
+
+      bool operator==(const entity_handle_s & other) const
+      {
+         return bits == other.bits;
+      }
+
+      bool operator!=(const entity_handle_s & other) const
+      {
+         return bits != other.bits;
+      }
+   } entity_handle_t;
+
+   inline entity_handle_t makeEntityHandle(uid_t uid, uint32_t generation)
+   {
+      entity_handle_t handle;
+      handle.bits = (
+         (static_cast<uint64_t>(generation) << 32) |
+         (static_cast<uint64_t>(uid) & 0xffffffffu)
+      );
+
+      return handle;
+   }
+
+   // Never refers to an entity.
+   const entity_handle_t error_entity_handle = {~static_cast<uint64_t>(0)};
+
+   // Determines the order that an entity manager hands out entity UIDs.
+   //    - REUSE_FREED_UIDS: the most recently freed UID is handed out first.
+   //      Never-used UIDs are only handed out when no freed UIDs remain.
+   //    - LEGACY_UID_ORDER: every never-used UID is handed out in ascending
+   //      order before any freed UID, and freed UIDs are handed out in the
+   //      order they were freed.
+   typedef enum entity_uid_order
+   {
+      REUSE_FREED_UIDS = 0,
+      LEGACY_UID_ORDER = 1
+   } entity_uid_order_enum_t;
+
    typedef enum edge_flag
    {
       TRANSITIVE = 0,
@@ -9,6 +9,7 @@
 #include "entity_manager.hpp"
 
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace trecs
@@ -32,6 +33,37 @@ namespace trecs
             , registration_locked_(false)
          { }
 
+         // Allocates the ECB's component pools from a memory resource. The
+         // resource must outlive the ECB.
+         EntityComponentBuffer(
+            size_t max_buffer_size, IMemoryResource * resource
+         )
+            : max_buffer_size_(max_buffer_size)
+            , num_entities_(0)
+            , components_(max_buffer_size_, PER_TYPE_POOLS, resource)
+            , registration_locked_(false)
+         { }
+
+         // Copies the source ECB into this destination ECB without releasing
+         // the source ECB's ownership of its data pools. The source ECB must
+         // be released after the copy.
+         EntityComponentBuffer(const EntityComponentBuffer & other)
+            : max_buffer_size_(other.max_buffer_size_)
+            , num_entities_(other.num_entities_)
+            , components_(other.components_)
+            , registration_locked_(other.registration_locked_)
+            , tags_(other.tags_)
+         { }
+
+         // Moves the source ECB's data pools into this ECB.
+         EntityComponentBuffer(EntityComponentBuffer && other)
+            : max_buffer_size_(other.max_buffer_size_)
+            , num_entities_(other.num_entities_)
+            , components_(std::move(other.components_))
+            , registration_locked_(other.registration_locked_)
+            , tags_(std::move(other.tags_))
+         { }
+
          // Copies the source ECB into this destination ECB without releasing
          // the source ECB's ownership of its data pools.
          EntityComponentBuffer & operator=(const EntityComponentBuffer & other)
@@ -45,6 +77,7 @@ namespace trecs
             num_entities_ = other.num_entities_;
             components_ = other.components_;
             registration_locked_ = other.registration_locked_;
+            tags_ = other.tags_;
 
             return *this;
          }
@@ -62,15 +95,24 @@ namespace trecs
             num_entities_ = other.num_entities_;
             components_ = other.components_;
             registration_locked_ = other.registration_locked_;
+            tags_ = other.tags_;
 
             return *this;
          }
 
+         // Moves the source ECB's data pools into this ECB.
+         EntityComponentBuffer & operator=(EntityComponentBuffer && other)
+         {
+            EntityComponentBuffer & other_ref = other;
+            return *this = other_ref;
+         }
+
          // Resets all of the entities and components in the ECB.
          void clear(void)
          {
             num_entities_ = 0;
             components_.clear();
+            tags_.clear();
          }
 
          // Component types will not be registerable with the ECB after this
@@ -89,6 +131,7 @@ namespace trecs
 
             uid_t new_entity = num_entities_;
             ++num_entities_;
+            tags_.push_back(DefaultArchetype());
             return new_entity;
          }
 
@@ -151,7 +194,24 @@ namespace trecs
          template <typename Component_T>
          std::vector<uid_t> getComponentEntities(void) const
          {
-            return components_.getComponentEntities<Component_T>();
+            return getComponentEntities<Component_T>(
+               IsTagComponent<Component_T>()
+            );
+         }
+
+         // Returns true if a component of a particular type has been added
+         // to an entity in the ECB.
+         template <typename Component_T>
+         bool hasComponent(uid_t entity_uid) const
+         {
+            if (entity_uid >= num_entities_ || entity_uid < 0)
+            {
+               return false;
+            }
+
+            return hasComponent<Component_T>(
+               entity_uid, IsTagComponent<Component_T>()
+            );
          }
 
          // Attempts to update a component on an active entity UID. If a
@@ -168,16 +228,12 @@ namespace trecs
                return false;
             }
 
-            Component_T * old_component = components_.getComponent<Component_T>(entity_uid);
-
             // This is just as good as checking if an entity's current
-            // archetype supports a component signature. If the component
-            // attached to the entity is null, then that component hasn't been
-            // added to the entity, and the entity's archetype does't support
-            // the component's signature.
-            if (old_component != nullptr)
+            // archetype supports a component signature. If there's no
+            // component of this type attached to the entity, then the
+            // entity's archetype doesn't support the component's signature.
+            if (components_.assignComponent<Component_T>(entity_uid, component))
             {
-               *old_component = component;
                return true;
             }
 
@@ -189,6 +245,14 @@ namespace trecs
                return false;
             }
 
+            // Tags aren't stored by the component manager, so the ECB keeps
+            // track of them itself.
+            if (IsTagComponent<Component_T>::value)
+            {
+               tags_[entity_uid].mergeSignature(component_sig);
+               return true;
+            }
+
             return components_.addComponent(entity_uid, component) >= 0;
          }
 
@@ -222,6 +286,53 @@ namespace trecs
 
          bool registration_locked_;
 
+         // The tag components on each entity in the ECB.
+         std::vector<DefaultArchetype> tags_;
+
+         template <typename Component_T>
+         std::vector<uid_t> getComponentEntities(std::true_type) const
+         {
+            std::vector<uid_t> entities;
+            signature_t component_sig = components_.getSignature<Component_T>();
+            if (component_sig == error_signature)
+            {
+               return entities;
+            }
+
+            for (size_t i = 0; i < tags_.size(); ++i)
+            {
+               if (tags_[i].supports(component_sig))
+               {
+                  entities.push_back(static_cast<uid_t>(i));
+               }
+            }
+
+            return entities;
+         }
+
+         template <typename Component_T>
+         std::vector<uid_t> getComponentEntities(std::false_type) const
+         {
+            return components_.getComponentEntities<Component_T>();
+         }
+
+         template <typename Component_T>
+         bool hasComponent(uid_t entity_uid, std::true_type) const
+         {
+            signature_t component_sig = components_.getSignature<Component_T>();
+
+            return (
+               (component_sig != error_signature) &&
+               tags_[entity_uid].supports(component_sig)
+            );
+         }
+
+         template <typename Component_T>
+         bool hasComponent(uid_t entity_uid, std::false_type) const
+         {
+            return components_.hasComponent<Component_T>(entity_uid);
+         }
+
          template <class T>
          void supportsComponents(bool & supported) const
          {
@@ -3,24 +3,38 @@
 
 #include "archetype.hpp"
 #include "ecs_types.hpp"
+#include "paged_sparse_array.hpp"
+#include "uid_reservation.hpp"
 
 #include <cstddef>
+#include <deque>
 #include <vector>
 
 namespace trecs
 {
 
-   // The entity manager is essentially a thin wrapper around a deque. It
-   // tracks all of the UIDs that have been given out, and all of the UIDs that
-   // are still available. It also includes a signature system where signatures
-   // indicate unique component types. Component types are positive powers of
-   // two, and a signature for a given entity can be specified externally.
+   // The entity manager tracks all of the UIDs that have been given out, and
+   // all of the UIDs that are still available. It also includes a signature
+   // system where signatures indicate unique component types. Component
+   // types are positive powers of two, and a signature for a given entity can
+   // be specified externally.
+   //
+   // UIDs that have never been used are handed out from a high-water mark,
+   // and freed UIDs are kept on a free list, so adding an entity and
+   // constructing the manager are both constant time. Per-UID bookkeeping
+   // lives in a paged sparse array, so memory is only allocated for pages of
+   // UIDs that have been handed out and existing bookkeeping is never copied
+   // as the number of entities grows.
    class EntityManager
    {
       public:
          // Initialize an entity manager with a maximum entity UID.
          EntityManager(uid_t max_entity_uid);
 
+         // Initialize an entity manager with a maximum entity UID and the
+         // order that UIDs are handed out in.
+         EntityManager(uid_t max_entity_uid, entity_uid_order_enum_t uid_order);
+
          EntityManager & operator=(const EntityManager & other);
 
          void clear(void);
@@ -29,6 +43,27 @@ namespace trecs
          // returns -1 if unsuccessful.
          uid_t addEntity(void);
 
+         // Reserves up to 'count' contiguous UIDs that have never been
+         // handed out. Reserved UIDs aren't handed out by 'addEntity' until
+         // they're released. Returns a smaller or empty reservation if there
+         // aren't enough UIDs left. Clearing the manager invalidates all of
+         // its outstanding reservations.
+         UidReservation reserveUids(size_t count);
+
+         // Adds an active entity with a UID that was taken from one of this
+         // manager's reservations. Returns the entity UID if successful, or
+         // returns -1 if the UID isn't reserved.
+         uid_t addReservedEntity(uid_t entity_uid);
+
+         // Returns the UIDs that haven't been taken from a reservation to the
+         // manager and empties the reservation. UIDs that were taken but
+         // never added as entities can be returned with 'releaseUid'.
+         void releaseReservation(UidReservation & reservation);
+
+         // Returns a reserved UID that was never added as an entity to the
+         // manager.
+         void releaseUid(uid_t entity_uid);
+
          // Removes an active entity.
          void removeEntity(uid_t entity_uid);
 
@@ -36,9 +71,33 @@ namespace trecs
          // Returns false if the given entity UID is not active.
          bool entityActive(uid_t entity_uid) const;
 
-         // Returns all active entity UIDs.
+         // Returns a handle to an active entity. Returns
+         // 'error_entity_handle' if the entity isn't active.
+         entity_handle_t getHandle(uid_t entity_uid) const;
+
+         // Returns true if the handle refers to an entity that is still
+         // active. Handles to removed entities stay invalid even after their
+         // UIDs are reused.
+         bool handleValid(entity_handle_t handle) const;
+
+         // Returns all active entity UIDs. Removing an entity moves the last
+         // UID into the removed UID's place, so the order isn't stable.
          const std::vector<uid_t> & getUids(void) const;
 
+         // Enables or disables an active entity. Doesn't change the entity's
+         // archetype. Returns false if the entity isn't active.
+         bool setEnabled(uid_t entity_uid, bool enabled);
+
+         // Returns true if the entity is active and enabled. Entities are
+         // enabled when they're added.
+         bool entityEnabled(uid_t entity_uid) const;
+
+         // Returns the number of active entities that are disabled.
+         std::size_t numDisabled(void) const
+         {
+            return num_disabled_;
+         }
+
          // Allows external designation of the archetype of a given entity.
          bool setArchetype(
             uid_t entity_uid, const DefaultArchetype & archetype
@@ -57,19 +116,72 @@ namespace trecs
 
          std::size_t size(void) const;
 
+         // Returns the number of entities that can still be added.
+         std::size_t numAvailable(void) const;
+
       private:
 
-         // Hard-coded meta-max entity UID. This is implicitly determined by
-         // the bit-level encodings in the edge entity UID.
+         // Hard-coded meta-max entity UID. Entity handles store UIDs in 32
+         // bits, and the largest 32-bit UID is reserved for
+         // 'error_entity_handle'.
          const uid_t meta_max_entity_uid_;
 
          uid_t max_entity_uid_;
 
-         std::vector<uid_t> uid_pool_;
+         entity_uid_order_enum_t uid_order_;
+
+         // The smallest UID that has never been handed out since the last
+         // clear.
+         uid_t next_unused_uid_;
 
+         // The number of UIDs that are reserved but haven't been added or
+         // released.
+         size_t num_reserved_;
+
+         // The number of active entities that are disabled.
+         size_t num_disabled_;
+
+         // Freed UIDs that can be handed out again.
+         std::deque<uid_t> free_uids_;
+
+         // Active entity UIDs, packed in no particular order.
          std::vector<uid_t> uids_;
 
-         std::vector<DefaultArchetype> archetypes_;
+         // Everything the manager knows about one entity UID.
+         typedef struct entity_slot_s
+         {
+            // The UID's index in 'uids_', or 'invalid_index_' if the entity
+            // isn't active. Makes liveness checks and removals constant time.
+            size_t dense_index;
+
+            // Incremented whenever the UID's entity is removed.
+            uint32_t generation;
+
+            // Disabled entities keep their components and query membership,
+            // they're only skipped by enabled-entity iteration.
+            bool enabled;
+
+            // True while the UID belongs to a reservation or has been taken
+            // from one but hasn't been added as an entity.
+            bool reserved;
+
+            DefaultArchetype archetype;
+         } entity_slot_t;
+
+         static const size_t invalid_index_ = static_cast<size_t>(-1);
+
+         // The slot of every entity UID. Pages of slots are allocated the
+         // first time a UID in their range is handed out.
+         PagedSparseArray<entity_slot_t> slots_;
+
+         static entity_slot_t emptySlot(void);
+
+         // Returns the next UID to hand out, or -1 if there are none left.
+         uid_t takeUid(void);
+
+         // Marks an inactive UID as an active, enabled entity with an empty
+         // archetype.
+         void activate(uid_t entity_uid);
 
    };
 
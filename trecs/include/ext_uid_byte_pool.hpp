@@ -4,9 +4,12 @@
 #include "data_pool_interface.hpp"
 
 #include "ecs_types.hpp"
+#include "object_ops.hpp"
 
 #include <cassert>
+#include <cstring>
 #include <map>
+#include <type_traits>
 #include <vector>
 
 #include <iostream>
@@ -61,13 +64,9 @@ namespace trecs
 
             initialize();
 
-            for (const auto & uid_to_index : other.uid_to_index_)
-            {
-               addComponent(
-                  uid_to_index.first,
-                  *other.getComponentFromIndex(uid_to_index.second)
-               );
-            }
+            copyComponentsFrom(
+               other, typename ObjectOps<T>::trivially_copyable_t()
+            );
 
             return *this;
          }
@@ -98,10 +97,11 @@ namespace trecs
          // Deletes the uid-index mapping.
          void clear(void) override
          {
-            for (size_t i = 0; i < max_num_bytes_; ++i)
-            {
-               data_pool_[i] = 0;
-            }
+            // Bytes past the last free index are always zero, so only the
+            // bytes of active components need to be cleared.
+            std::memset(
+               data_pool_ + index_offset_, 0, last_free_index_ - index_offset_
+            );
 
             last_free_index_ = index_offset_;
             uid_to_index_.clear();
@@ -122,7 +122,7 @@ namespace trecs
             }
 
             T * last_component = getComponentFromIndex(last_free_index_);
-            *last_component = component;
+            ObjectOps<T>::copyConstruct(last_component, &component, 1);
 
             uid_to_index_[new_component_uid] = last_free_index_;
 
@@ -179,7 +179,10 @@ namespace trecs
             size_t removed_index = uid_to_index_.at(uid_to_remove);
             T * removed_component = getComponentFromIndex(removed_index);
             T * last_component = getComponentFromIndex(last_free_index_ - index_increment_);
-            *removed_component = *last_component;
+            if (removed_component != last_component)
+            {
+               ObjectOps<T>::moveAssign(removed_component, last_component);
+            }
 
             // Update the index that the last component's UID maps to.
             uid_to_index_[uid_to_update] = removed_index;
@@ -192,10 +195,7 @@ namespace trecs
 
             // Zero out the bytes from the component that was moved to the
             // deleted component's index.
-            for (size_t i = 0; i < index_increment_; ++i)
-            {
-               data_pool_[last_free_index_ + i] = 0;
-            }
+            std::memset(data_pool_ + last_free_index_, 0, index_increment_);
          }
 
          // Using this method is not recommended because it's slow. But it's
@@ -280,9 +280,46 @@ namespace trecs
 
             last_free_index_ = index_offset_;
 
-            for (size_t i = 0; i < max_num_bytes_; ++i)
+            std::memset(data_pool_, 0, max_num_bytes_);
+         }
+
+         // Copies the active bytes of a trivially copyable pool in one block.
+         // The two pools' buffers can start at different offsets, so the
+         // copied indices are shifted by the difference in offsets.
+         void copyComponentsFrom(
+            const ExternalUidBytePool<T> & other, std::true_type
+         )
+         {
+            const size_t num_bytes = other.last_free_index_ - other.index_offset_;
+            std::memcpy(
+               data_pool_ + index_offset_,
+               other.data_pool_ + other.index_offset_,
+               num_bytes
+            );
+
+            // The source map is sorted, so every insertion goes at the end.
+            for (const auto & uid_to_index : other.uid_to_index_)
+            {
+               uid_to_index_.emplace_hint(
+                  uid_to_index_.end(),
+                  uid_to_index.first,
+                  uid_to_index.second - other.index_offset_ + index_offset_
+               );
+            }
+
+            last_free_index_ = index_offset_ + num_bytes;
+         }
+
+         void copyComponentsFrom(
+            const ExternalUidBytePool<T> & other, std::false_type
+         )
+         {
+            for (const auto & uid_to_index : other.uid_to_index_)
             {
-               data_pool_[i] = 0;
+               addComponent(
+                  uid_to_index.first,
+                  *other.getComponentFromIndex(uid_to_index.second)
+               );
             }
          }
 
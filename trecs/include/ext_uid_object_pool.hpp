@@ -4,33 +4,69 @@
 #include "data_pool_interface.hpp"
 
 #include "ecs_types.hpp"
+#include "memory_resource.hpp"
+#include "object_ops.hpp"
+#include "paged_sparse_array.hpp"
+#include "permutation.hpp"
+#include "span.hpp"
 
+#include <algorithm>
 #include <cassert>
-#include <map>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <iostream>
 
 namespace trecs
 {
+   // The target number of bytes in one page of an object pool.
+   const size_t default_pool_page_size_bytes = 16 * 1024;
+
+   // The base-2 logarithm of 'n', rounded down.
+   constexpr size_t floorLog2(size_t n)
+   {
+      return (n <= 1) ? 0 : (1 + floorLog2(n / 2));
+   }
+
+   // A pool of objects keyed by externally provided UIDs. Objects are stored
+   // in a sparse set: a paged sparse array maps UIDs to indices in a dense
+   // array of UIDs and a parallel dense array of objects. Lookups, insertions,
+   // and swap-removals are all constant time.
+   //
+   // The dense array of objects is split into fixed-size pages that are
+   // allocated as the pool grows, so memory use scales with the number of
+   // objects in the pool rather than with its capacity. Pages are never
+   // reallocated, so the address of an object at a given dense index is
+   // stable until the pool is destroyed or assigned to.
+   //
+   // Pages are raw storage. Objects are constructed in place when they're
+   // added and destroyed when they're removed, so only the first 'size()'
+   // slots of the dense array hold live objects.
    template <typename Object_T>
    class ExternalUidObjectPool : public IDataPool
    {
       public:
 
          ExternalUidObjectPool(size_t num_elements)
+            : ExternalUidObjectPool(num_elements, defaultMemoryResource())
+         { }
+
+         // Allocates pages of objects and UID-index mappings from a memory
+         // resource. The resource must outlive the pool.
+         ExternalUidObjectPool(size_t num_elements, IMemoryResource * resource)
             : max_num_elements_(num_elements)
-            , data_pool_(nullptr)
+            , resource_(resource)
+            , uid_to_index_(invalid_index_, resource)
          {
             assert(max_num_elements_ > 0);
-
-            initialize();
          }
 
          ~ExternalUidObjectPool(void) override
          {
-            delete [] data_pool_;
-            data_pool_ = nullptr;
+            clear();
+            freePages();
          }
 
          ExternalUidObjectPool<Object_T> & operator=(
@@ -43,24 +79,24 @@ namespace trecs
             }
 
             clear();
-
-            if (data_pool_ != nullptr)
-            {
-               delete [] data_pool_;
-            }
+            freePages();
 
             max_num_elements_ = other.max_num_elements_;
 
-            initialize();
-
-            for (const auto & uid_to_index : other.uid_to_index_)
+            // The dense arrays can be copied directly since the UID-index
+            // mapping is copied verbatim. Both pools have the same page size,
+            // so components are copied a page at a time.
+            for (size_t i = 0; i < other.numPages(); ++i)
             {
-               addComponent(
-                  uid_to_index.first,
-                  *other.getComponent(uid_to_index.first)
+               allocatePage();
+               ObjectOps<Object_T>::copyConstruct(
+                  pages_[i], other.pages_[i], other.pageLength(i)
                );
             }
 
+            dense_uids_ = other.dense_uids_;
+            uid_to_index_ = other.uid_to_index_;
+
             return *this;
          }
 
@@ -85,112 +121,300 @@ namespace trecs
             return *this;
          }
 
-         // Resets the last free index to the 0. Deletes the uid-index mapping.
+         // Destroys all of the objects in the pool and deletes the uid-index
+         // mapping and the dense list of UIDs. Pages that have already been
+         // allocated are kept for reuse.
          void clear(void) override
          {
-            last_free_index_ = 0;
+            for (size_t i = 0; i < numPages(); ++i)
+            {
+               ObjectOps<Object_T>::destroy(pages_[i], pageLength(i));
+            }
+
+            dense_uids_.clear();
             uid_to_index_.clear();
          }
 
          // Returns 'new_component_uid' if the component is successfully added
          // to the data pool. Returns -1 otherwise.
          uid_t addComponent(uid_t new_component_uid, const Object_T & component)
+         {
+            return emplaceComponent(new_component_uid, component);
+         }
+
+         // Moves a component into the data pool. Returns 'new_component_uid'
+         // if the component is successfully added to the data pool. Returns
+         // -1 otherwise.
+         uid_t addComponent(uid_t new_component_uid, Object_T && component)
+         {
+            return emplaceComponent(new_component_uid, std::move(component));
+         }
+
+         // Constructs a component in place from a list of constructor
+         // arguments. Returns 'new_component_uid' if the component is
+         // successfully added to the data pool. Returns -1 otherwise.
+         template <typename...Args>
+         uid_t emplaceComponent(uid_t new_component_uid, Args &&... args)
          {
             if (size() >= max_num_elements_)
             {
                return -1;
             }
 
-            if (uid_to_index_.find(new_component_uid) != uid_to_index_.end())
+            if (new_component_uid < 0)
+            {
+               std::cout << "Couldn't add negative UID " << new_component_uid << "\n";
+               return -1;
+            }
+
+            if (uid_to_index_.get(new_component_uid) != invalid_index_)
             {
                std::cout << "Couldn't add UID " << new_component_uid << " because it already exists\n";
                return -1;
             }
 
-            data_pool_[last_free_index_] = component;
-            uid_to_index_[new_component_uid] = last_free_index_;
-            ++last_free_index_;
+            const size_t new_index = dense_uids_.size();
+            if (pageIndex(new_index) >= pages_.size())
+            {
+               allocatePage();
+            }
+
+            new (&at(new_index)) Object_T(std::forward<Args>(args)...);
+            uid_to_index_.set(new_component_uid, new_index);
+            dense_uids_.push_back(new_component_uid);
 
             return new_component_uid;
          }
 
+         // Adds a copy of 'prototype' at every UID in 'uids'. Room for the
+         // whole batch is reserved up front. Returns false without adding
+         // anything if any UID is negative, repeated, or already in the
+         // pool, or if the batch doesn't fit.
+         bool addComponents(Span<const uid_t> uids, const Object_T & prototype)
+         {
+            const size_t first_index = size();
+            if (!claimUids(uids))
+            {
+               return false;
+            }
+
+            for (size_t i = 0; i < uids.size(); ++i)
+            {
+               new (&at(first_index + i)) Object_T(prototype);
+            }
+
+            return true;
+         }
+
+         // Adds 'components[i]' at 'uids[i]' for every UID. Components are
+         // copied a page at a time. Follows the same rules as adding copies
+         // of a prototype.
+         bool addComponents(
+            Span<const uid_t> uids, Span<const Object_T> components
+         )
+         {
+            if (uids.size() != components.size())
+            {
+               std::cout << "Couldn't add " << components.size() << " components to " << uids.size() << " UIDs\n";
+               return false;
+            }
+
+            const size_t first_index = size();
+            if (!claimUids(uids))
+            {
+               return false;
+            }
+
+            size_t num_copied = 0;
+            while (num_copied < components.size())
+            {
+               const size_t index = first_index + num_copied;
+               const size_t page_remaining = \
+                  elements_per_page_ - (index & (elements_per_page_ - 1));
+               const size_t batch_remaining = components.size() - num_copied;
+               const size_t run_length = (page_remaining < batch_remaining) ? \
+                  page_remaining : batch_remaining;
+
+               ObjectOps<Object_T>::copyConstruct(
+                  &at(index), components.data() + num_copied, run_length
+               );
+               num_copied += run_length;
+            }
+
+            return true;
+         }
+
+         // Allocates enough pages to hold 'num_elements' components, up to
+         // the capacity of the pool.
+         void reserve(size_t num_elements)
+         {
+            if (num_elements > max_num_elements_)
+            {
+               num_elements = max_num_elements_;
+            }
+
+            while (pages_.size() * elements_per_page_ < num_elements)
+            {
+               allocatePage();
+            }
+         }
+
          Object_T * getComponent(uid_t uid)
          {
-            auto uid_index = uid_to_index_.find(uid);
-            if (uid_index == uid_to_index_.end())
+            const size_t index = uid_to_index_.get(uid);
+            if (index == invalid_index_)
             {
                return nullptr;
             }
 
-            return &(data_pool_[uid_index->second]);
+            return &at(index);
          }
 
          const Object_T * getComponent(uid_t uid) const
          {
-            auto uid_index = uid_to_index_.find(uid);
-            if (uid_index == uid_to_index_.end())
+            const size_t index = uid_to_index_.get(uid);
+            if (index == invalid_index_)
             {
                return nullptr;
             }
 
-            return &(data_pool_[uid_index->second]);
+            return &at(index);
          }
 
-         // Move the last item in the component array to the removed slot.
-         // Update the ID map to map the ID of the last-index component to the
-         // removed index.
+         // Move the last item in the component array to the removed slot and
+         // destroy the last item. Update the ID map to map the ID of the
+         // last-index component to the removed index.
          void removeComponent(uid_t uid_to_remove) override
          {
-            if (uid_to_index_.find(uid_to_remove) == uid_to_index_.end())
+            const size_t removed_index = uid_to_index_.get(uid_to_remove);
+            if (removed_index == invalid_index_)
             {
                return;
             }
 
-            // Find the UID of the component that maps to the last free index
-            // in the data array.
-            uid_t uid_to_update = -1;
-            for (const auto & uid_index : uid_to_index_)
+            // The UID of the component at the last index of the dense array
+            // is always the last entry in the dense UID array.
+            const size_t last_index = dense_uids_.size() - 1;
+
+            if (removed_index != last_index)
+            {
+               // Move last component into the removed component's location.
+               const uid_t uid_to_update = dense_uids_[last_index];
+               ObjectOps<Object_T>::moveAssign(&at(removed_index), &at(last_index));
+               dense_uids_[removed_index] = uid_to_update;
+
+               // Update the index that the last component's UID maps to.
+               uid_to_index_.set(uid_to_update, removed_index);
+            }
+
+            // Destroy the moved-from or removed component at the end of the
+            // dense array, remove the UID entry in the UID-index mapping, and
+            // shrink the dense array.
+            ObjectOps<Object_T>::destroy(&at(last_index), 1);
+            uid_to_index_.reset(uid_to_remove);
+            dense_uids_.pop_back();
+         }
+
+         // Sorts the components in memory with a comparison function that
+         // takes two const component references and returns true if the
+         // first component goes before the second. The sort is stable.
+         template <typename Compare_T>
+         void sort(Compare_T compare)
+         {
+            std::vector<size_t> order(size());
+            for (size_t i = 0; i < order.size(); ++i)
             {
-               if (uid_index.second == (last_free_index_ - 1))
+               order[i] = i;
+            }
+
+            std::stable_sort(
+               order.begin(),
+               order.end(),
+               [this, &compare](size_t a, size_t b)
                {
-                  uid_to_update = uid_index.first;
-                  break;
+                  return compare(at(a), at(b));
                }
+            );
+
+            permute(order);
+         }
+
+         void reorder(const std::vector<uid_t> & front_uids) override
+         {
+            std::vector<size_t> front_indices;
+            front_indices.reserve(front_uids.size());
+            for (const auto uid : front_uids)
+            {
+               front_indices.push_back(uid_to_index_.get(uid));
             }
 
-            // Move last component into the removed component's location.
-            size_t removed_index = uid_to_index_.at(uid_to_remove);
-            Object_T & removed_component = data_pool_[removed_index];
-            Object_T & last_component = data_pool_[last_free_index_ - 1];
-            removed_component = last_component;
+            permute(frontFirstOrder(size(), front_indices));
+         }
+
+         // Returns the UIDs of all of the components in the pool in the same
+         // order as the components are stored in memory.
+         const std::vector<uid_t> & getUids(void) const
+         {
+            return dense_uids_;
+         }
+
+         // Returns the component at a dense index. The component at index 'i'
+         // belongs to the UID at index 'i' of 'getUids()'.
+         Object_T & componentAt(size_t index)
+         {
+            return at(index);
+         }
 
-            // Update the index that the last component's UID maps to.
-            uid_to_index_[uid_to_update] = removed_index;
+         const Object_T & componentAt(size_t index) const
+         {
+            return at(index);
+         }
 
-            // Remove the UID entry in the UID-index mapping.
-            uid_to_index_.erase(uid_to_remove);
+         // The maximum number of components in one page of the dense array.
+         static size_t pageSize(void)
+         {
+            return elements_per_page_;
+         }
 
-            // Decrement the last free index.
-            last_free_index_ -= 1;
+         // Returns the number of pages that hold at least one component.
+         size_t numPages(void) const
+         {
+            return (size() + elements_per_page_ - 1) / elements_per_page_;
          }
 
-         // Using this method is not recommended because it's slow. But it's
-         // good for tests.
-         std::vector<uid_t> getUids(void) const
+         // Returns the components in one page of the dense array. Every page
+         // except the last one is full.
+         Span<Object_T> page(size_t page_index)
          {
-            std::vector<uid_t> uids;
-            for (const auto & uid_to_index: uid_to_index_)
+            if (page_index >= numPages())
             {
-               uids.push_back(uid_to_index.first);
+               return Span<Object_T>();
             }
 
-            return uids;
+            return Span<Object_T>(pages_[page_index], pageLength(page_index));
+         }
+
+         Span<const Object_T> page(size_t page_index) const
+         {
+            if (page_index >= numPages())
+            {
+               return Span<const Object_T>();
+            }
+
+            return Span<const Object_T>(pages_[page_index], pageLength(page_index));
+         }
+
+         // Returns the number of pages that have been allocated, including
+         // pages that are currently empty.
+         size_t numAllocatedPages(void) const
+         {
+            return pages_.size();
          }
 
          // Returns the number of active components in the pool.
          size_t size(void) const override
          {
-            return uid_to_index_.size();
+            return dense_uids_.size();
          }
 
          // Returns the maximum number of components that can be held in this
@@ -202,26 +426,152 @@ namespace trecs
 
       private:
 
+         // Marks UIDs in the sparse array that aren't in the pool.
+         static const size_t invalid_index_ = static_cast<size_t>(-1);
+
+         // Every page holds a power-of-two number of objects so that dense
+         // indices can be split into page and offset with a shift and a mask.
+         static const size_t page_shift_ = floorLog2(
+            (sizeof(Object_T) < default_pool_page_size_bytes) ?
+               (default_pool_page_size_bytes / sizeof(Object_T)) : 1
+         );
+
+         static const size_t elements_per_page_ = static_cast<size_t>(1) << page_shift_;
+
          // The maximum number of elements of type T in the data pool.
          size_t max_num_elements_;
 
-         // An index of the data array where the next element T should be
-         // inserted.
-         size_t last_free_index_;
+         // The source of memory for pages of objects.
+         IMemoryResource * resource_;
+
+         // The underlying data structure. Objects are densely packed in the
+         // first 'size()' elements across all pages.
+         std::vector<Object_T *> pages_;
+
+         // The UID of each object in the dense data array, in the same order
+         // as the objects.
+         std::vector<uid_t> dense_uids_;
+
+         // A conversion from UID to index in the dense arrays.
+         PagedSparseArray<size_t> uid_to_index_;
+
+         static size_t pageIndex(size_t index)
+         {
+            return index >> page_shift_;
+         }
+
+         Object_T & at(size_t index)
+         {
+            return pages_[pageIndex(index)][index & (elements_per_page_ - 1)];
+         }
+
+         const Object_T & at(size_t index) const
+         {
+            return pages_[pageIndex(index)][index & (elements_per_page_ - 1)];
+         }
+
+         // Moves the component at index 'order[i]' to index 'i' and updates
+         // the UID-index mapping to match.
+         void permute(const std::vector<size_t> & order)
+         {
+            applyPermutation(
+               order,
+               [this](size_t a, size_t b)
+               {
+                  using std::swap;
+                  swap(at(a), at(b));
+                  swap(dense_uids_[a], dense_uids_[b]);
+               }
+            );
+
+            for (size_t i = 0; i < dense_uids_.size(); ++i)
+            {
+               uid_to_index_.set(dense_uids_[i], i);
+            }
+         }
 
-         // The underlying data structure.
-         Object_T * data_pool_;
+         // Maps a batch of new UIDs to the dense indices after the last
+         // component and reserves pages for them. The components at those
+         // indices still have to be constructed. Returns false without
+         // changing the pool if any UID can't be added.
+         bool claimUids(Span<const uid_t> uids)
+         {
+            if (uids.size() > max_num_elements_ - size())
+            {
+               std::cout << "Couldn't add " << uids.size() << " components, the pool is too small\n";
+               return false;
+            }
 
-         // A conversion from UID to index.
-         std::map<uid_t, size_t> uid_to_index_;
+            const size_t first_index = size();
+            for (size_t i = 0; i < uids.size(); ++i)
+            {
+               if (uids[i] < 0 || uid_to_index_.get(uids[i]) != invalid_index_)
+               {
+                  std::cout << "Couldn't add UID " << uids[i] << " because it's negative or it already exists\n";
+                  for (size_t j = 0; j < i; ++j)
+                  {
+                     uid_to_index_.reset(uids[j]);
+                  }
 
-         void initialize(void)
+                  return false;
+               }
+
+               uid_to_index_.set(uids[i], first_index + i);
+            }
+
+            reserve(first_index + uids.size());
+            dense_uids_.insert(dense_uids_.end(), uids.begin(), uids.end());
+
+            return true;
+         }
+
+         size_t pageLength(size_t page_index) const
          {
-            data_pool_ = new Object_T[max_num_elements_];
-            last_free_index_ = 0;
+            const size_t page_start = page_index * elements_per_page_;
+            const size_t remaining = size() - page_start;
+            return (remaining < elements_per_page_) ? remaining : elements_per_page_;
+         }
+
+         void allocatePage(void)
+         {
+            Object_T * page_ptr = static_cast<Object_T *>(
+               resource_->allocate(
+                  elements_per_page_ * sizeof(Object_T), alignof(Object_T)
+               )
+            );
+
+            if (page_ptr == nullptr)
+            {
+               throw std::bad_alloc();
+            }
+
+            pages_.push_back(page_ptr);
+         }
+
+         // Frees the raw storage for all pages. Live objects must be
+         // destroyed first.
+         void freePages(void)
+         {
+            for (auto page_ptr : pages_)
+            {
+               resource_->deallocate(
+                  page_ptr, elements_per_page_ * sizeof(Object_T), alignof(Object_T)
+               );
+            }
+
+            pages_.clear();
          }
 
    };
+
+   template <typename Object_T>
+   const size_t ExternalUidObjectPool<Object_T>::invalid_index_;
+
+   template <typename Object_T>
+   const size_t ExternalUidObjectPool<Object_T>::page_shift_;
+
+   template <typename Object_T>
+   const size_t ExternalUidObjectPool<Object_T>::elements_per_page_;
 }
 
 #endif
@@ -0,0 +1,663 @@
+#ifndef EXTERNAL_UID_SOA_POOL_HEADER
+#define EXTERNAL_UID_SOA_POOL_HEADER
+
+#include "data_pool_interface.hpp"
+
+#include "ecs_types.hpp"
+#include "memory_resource.hpp"
+#include "paged_sparse_array.hpp"
+#include "permutation.hpp"
+#include "span.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <iostream>
+
+namespace trecs
+{
+   // Every column in a structure-of-arrays pool starts on this byte boundary,
+   // which is wide enough for aligned AVX2 and AVX-512 loads.
+   const size_t soa_column_alignment = 64;
+
+   // Column lengths are padded to a multiple of this many floats so that
+   // 8-wide SIMD loops can run over the padded tail without a scalar
+   // remainder loop. Padding is always zero.
+   const size_t soa_lane_width = 8;
+
+   // Component types opt into structure-of-arrays storage by specializing
+   // this trait. A specialization describes the component's float fields:
+   //
+   //    namespace trecs
+   //    {
+   //       template <>
+   //       struct SoaTraits<pos_t>
+   //       {
+   //          static const bool enabled = true;
+   //          static const size_t num_fields = 3;
+   //
+   //          static float getField(const pos_t & pos, size_t field)
+   //          {
+   //             return pos.vec[field];
+   //          }
+   //
+   //          static void setField(pos_t & pos, size_t field, float value)
+   //          {
+   //             pos.vec[field] = value;
+   //          }
+   //       };
+   //    }
+   //
+   // Only the described fields are stored. Components are rebuilt from their
+   // fields by default-constructing them and then setting each field.
+   template <typename Component_T>
+   struct SoaTraits
+   {
+      static const bool enabled = false;
+      static const size_t num_fields = 0;
+   };
+
+   // Float columns of a structure-of-arrays pool. Element 'i' of every column
+   // belongs to the entity UID at index 'i' of 'uids()'. The view is
+   // invalidated by adding or removing components.
+   template <typename Component_T>
+   class SoaView
+   {
+      public:
+         static const size_t num_fields = SoaTraits<Component_T>::num_fields;
+
+         SoaView(void)
+            : size_(0)
+            , padded_size_(0)
+            , uids_(nullptr)
+         {
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               columns_[i] = nullptr;
+            }
+         }
+
+         SoaView(
+            float * const * columns,
+            const uid_t * uids,
+            size_t size,
+            size_t padded_size
+         )
+            : size_(size)
+            , padded_size_(padded_size)
+            , uids_(uids)
+         {
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               columns_[i] = columns[i];
+            }
+         }
+
+         // The number of components in every column.
+         size_t size(void) const
+         {
+            return size_;
+         }
+
+         // The number of floats in every column including the zeroed tail
+         // padding. Always a multiple of 'soa_lane_width'.
+         size_t paddedSize(void) const
+         {
+            return padded_size_;
+         }
+
+         bool empty(void) const
+         {
+            return size_ == 0;
+         }
+
+         // Returns the column for one field. Columns are aligned to
+         // 'soa_column_alignment' bytes.
+         float * column(size_t field) const
+         {
+            return (field < num_fields) ? columns_[field] : nullptr;
+         }
+
+         Span<const uid_t> uids(void) const
+         {
+            return Span<const uid_t>(uids_, size_);
+         }
+
+      private:
+
+         size_t size_;
+
+         size_t padded_size_;
+
+         const uid_t * uids_;
+
+         float * columns_[(num_fields > 0) ? num_fields : 1];
+   };
+
+   template <typename Component_T>
+   const size_t SoaView<Component_T>::num_fields;
+
+   // A pool of components keyed by externally provided UIDs that stores each
+   // float field of the component type in its own aligned column. Like
+   // 'ExternalUidObjectPool', UIDs are mapped to dense indices through a
+   // paged sparse array and removals swap the last component into the
+   // removed slot.
+   //
+   // Components aren't stored as objects, so they're read and written by
+   // value instead of by pointer. Columns are reallocated as the pool grows.
+   template <typename Component_T>
+   class ExternalUidSoaPool : public IDataPool
+   {
+      static_assert(
+         SoaTraits<Component_T>::enabled,
+         "Component type must specialize SoaTraits for structure-of-arrays storage"
+      );
+
+      public:
+         static const size_t num_fields = SoaTraits<Component_T>::num_fields;
+
+         ExternalUidSoaPool(size_t num_elements)
+            : ExternalUidSoaPool(num_elements, defaultMemoryResource())
+         { }
+
+         // Allocates columns and UID-index mappings from a memory resource.
+         // The resource must outlive the pool.
+         ExternalUidSoaPool(size_t num_elements, IMemoryResource * resource)
+            : max_num_elements_(num_elements)
+            , resource_(resource)
+            , column_capacity_(0)
+            , uid_to_index_(invalid_index_, resource)
+         {
+            assert(max_num_elements_ > 0);
+
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               columns_[i] = nullptr;
+            }
+         }
+
+         ~ExternalUidSoaPool(void) override
+         {
+            freeColumns();
+         }
+
+         ExternalUidSoaPool<Component_T> & operator=(
+            const ExternalUidSoaPool<Component_T> & other
+         )
+         {
+            if (this == &other)
+            {
+               return *this;
+            }
+
+            clear();
+            freeColumns();
+
+            max_num_elements_ = other.max_num_elements_;
+
+            reserveColumns(other.size());
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               if (other.size() > 0)
+               {
+                  std::memcpy(
+                     columns_[i], other.columns_[i], other.size() * sizeof(float)
+                  );
+               }
+            }
+
+            dense_uids_ = other.dense_uids_;
+            uid_to_index_ = other.uid_to_index_;
+
+            return *this;
+         }
+
+         IDataPool & operator=(const IDataPool & other) override
+         {
+            if (this == &other)
+            {
+               return *this;
+            }
+
+            const ExternalUidSoaPool<Component_T> * other_derived_ptr = \
+               dynamic_cast<const ExternalUidSoaPool<Component_T> *>(&other);
+
+            if (other_derived_ptr == nullptr)
+            {
+               std::cout << "Couldn't downcast base pool class to derived pool class\n";
+               return *this;
+            }
+
+            *this = *other_derived_ptr;
+
+            return *this;
+         }
+
+         // Zeroes the columns and deletes the uid-index mapping and the dense
+         // list of UIDs. Columns are kept for reuse.
+         void clear(void) override
+         {
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               if (!dense_uids_.empty())
+               {
+                  std::memset(columns_[i], 0, dense_uids_.size() * sizeof(float));
+               }
+            }
+
+            dense_uids_.clear();
+            uid_to_index_.clear();
+         }
+
+         // Returns 'new_component_uid' if the component is successfully added
+         // to the data pool. Returns -1 otherwise.
+         uid_t addComponent(uid_t new_component_uid, const Component_T & component)
+         {
+            if (size() >= max_num_elements_)
+            {
+               return -1;
+            }
+
+            if (new_component_uid < 0)
+            {
+               std::cout << "Couldn't add negative UID " << new_component_uid << "\n";
+               return -1;
+            }
+
+            if (uid_to_index_.get(new_component_uid) != invalid_index_)
+            {
+               std::cout << "Couldn't add UID " << new_component_uid << " because it already exists\n";
+               return -1;
+            }
+
+            const size_t new_index = dense_uids_.size();
+            reserveColumns(new_index + 1);
+            scatter(new_index, component);
+
+            uid_to_index_.set(new_component_uid, new_index);
+            dense_uids_.push_back(new_component_uid);
+
+            return new_component_uid;
+         }
+
+         // Adds the fields of 'prototype' at every UID in 'uids'. Columns are
+         // grown once for the whole batch and each column is filled in one
+         // pass. Returns false without adding anything if any UID is
+         // negative, repeated, or already in the pool, or if the batch
+         // doesn't fit.
+         bool addComponents(Span<const uid_t> uids, const Component_T & prototype)
+         {
+            const size_t first_index = size();
+            if (!claimUids(uids))
+            {
+               return false;
+            }
+
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               std::fill(
+                  columns_[i] + first_index,
+                  columns_[i] + first_index + uids.size(),
+                  SoaTraits<Component_T>::getField(prototype, i)
+               );
+            }
+
+            return true;
+         }
+
+         // Adds the fields of 'components[i]' at 'uids[i]' for every UID.
+         // Follows the same rules as adding copies of a prototype.
+         bool addComponents(
+            Span<const uid_t> uids, Span<const Component_T> components
+         )
+         {
+            if (uids.size() != components.size())
+            {
+               std::cout << "Couldn't add " << components.size() << " components to " << uids.size() << " UIDs\n";
+               return false;
+            }
+
+            const size_t first_index = size();
+            if (!claimUids(uids))
+            {
+               return false;
+            }
+
+            for (size_t i = 0; i < components.size(); ++i)
+            {
+               scatter(first_index + i, components[i]);
+            }
+
+            return true;
+         }
+
+         // Grows the columns so that they can hold 'num_elements' components,
+         // up to the capacity of the pool.
+         void reserve(size_t num_elements)
+         {
+            reserveColumns(
+               (num_elements < max_num_elements_) ? num_elements : max_num_elements_
+            );
+         }
+
+         // Builds a component from a list of constructor arguments and adds
+         // its fields to the pool.
+         template <typename...Args>
+         uid_t emplaceComponent(uid_t new_component_uid, Args &&... args)
+         {
+            const Component_T component(std::forward<Args>(args)...);
+            return addComponent(new_component_uid, component);
+         }
+
+         // Returns true if a component is associated with the UID.
+         bool hasComponent(uid_t uid) const
+         {
+            return uid_to_index_.get(uid) != invalid_index_;
+         }
+
+         // Copies the fields of the component at a UID into 'component'.
+         // Returns false if there is no component at the UID.
+         bool readComponent(uid_t uid, Component_T & component) const
+         {
+            const size_t index = uid_to_index_.get(uid);
+            if (index == invalid_index_)
+            {
+               return false;
+            }
+
+            gather(index, component);
+            return true;
+         }
+
+         // Overwrites the fields of the component at a UID. Returns false if
+         // there is no component at the UID.
+         bool writeComponent(uid_t uid, const Component_T & component)
+         {
+            const size_t index = uid_to_index_.get(uid);
+            if (index == invalid_index_)
+            {
+               return false;
+            }
+
+            scatter(index, component);
+            return true;
+         }
+
+         // Move the last component in every column to the removed slot and
+         // zero the last slot. Update the ID map to map the ID of the
+         // last-index component to the removed index.
+         void removeComponent(uid_t uid_to_remove) override
+         {
+            const size_t removed_index = uid_to_index_.get(uid_to_remove);
+            if (removed_index == invalid_index_)
+            {
+               return;
+            }
+
+            const size_t last_index = dense_uids_.size() - 1;
+
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               columns_[i][removed_index] = columns_[i][last_index];
+               columns_[i][last_index] = 0.f;
+            }
+
+            if (removed_index != last_index)
+            {
+               const uid_t uid_to_update = dense_uids_[last_index];
+               dense_uids_[removed_index] = uid_to_update;
+               uid_to_index_.set(uid_to_update, removed_index);
+            }
+
+            uid_to_index_.reset(uid_to_remove);
+            dense_uids_.pop_back();
+         }
+
+         // Sorts the components in the columns with a comparison function
+         // that takes two const component references and returns true if the
+         // first component goes before the second. The sort is stable.
+         template <typename Compare_T>
+         void sort(Compare_T compare)
+         {
+            std::vector<Component_T> components(size());
+            std::vector<size_t> order(size());
+            for (size_t i = 0; i < order.size(); ++i)
+            {
+               gather(i, components[i]);
+               order[i] = i;
+            }
+
+            std::stable_sort(
+               order.begin(),
+               order.end(),
+               [&components, &compare](size_t a, size_t b)
+               {
+                  return compare(components[a], components[b]);
+               }
+            );
+
+            permute(order);
+         }
+
+         void reorder(const std::vector<uid_t> & front_uids) override
+         {
+            std::vector<size_t> front_indices;
+            front_indices.reserve(front_uids.size());
+            for (const auto uid : front_uids)
+            {
+               front_indices.push_back(uid_to_index_.get(uid));
+            }
+
+            permute(frontFirstOrder(size(), front_indices));
+         }
+
+         // Returns the UIDs of all of the components in the pool in the same
+         // order as the components are stored in the columns.
+         const std::vector<uid_t> & getUids(void) const
+         {
+            return dense_uids_;
+         }
+
+         // Returns a view of the float columns.
+         SoaView<Component_T> view(void)
+         {
+            return SoaView<Component_T>(
+               columns_, dense_uids_.data(), size(), paddedSize(size())
+            );
+         }
+
+         // Returns the number of active components in the pool.
+         size_t size(void) const override
+         {
+            return dense_uids_.size();
+         }
+
+         // Returns the maximum number of components that can be held in this
+         // data pool.
+         size_t capacity(void) const override
+         {
+            return max_num_elements_;
+         }
+
+      private:
+
+         // Marks UIDs in the sparse array that aren't in the pool.
+         static const size_t invalid_index_ = static_cast<size_t>(-1);
+
+         // The maximum number of components in the data pool.
+         size_t max_num_elements_;
+
+         // The source of memory for the columns.
+         IMemoryResource * resource_;
+
+         // The number of floats allocated for every column. Always a multiple
+         // of 'soa_lane_width'.
+         size_t column_capacity_;
+
+         // One aligned array of floats per field.
+         float * columns_[(num_fields > 0) ? num_fields : 1];
+
+         // The UID of each component in the dense columns, in the same order
+         // as the columns.
+         std::vector<uid_t> dense_uids_;
+
+         // A conversion from UID to index in the dense columns.
+         PagedSparseArray<size_t> uid_to_index_;
+
+         static size_t paddedSize(size_t num_elements)
+         {
+            return (
+               (num_elements + soa_lane_width - 1) / soa_lane_width
+            ) * soa_lane_width;
+         }
+
+         // Moves the component at index 'order[i]' to index 'i' in every
+         // column and updates the UID-index mapping to match.
+         void permute(const std::vector<size_t> & order)
+         {
+            applyPermutation(
+               order,
+               [this](size_t a, size_t b)
+               {
+                  for (size_t i = 0; i < num_fields; ++i)
+                  {
+                     std::swap(columns_[i][a], columns_[i][b]);
+                  }
+
+                  std::swap(dense_uids_[a], dense_uids_[b]);
+               }
+            );
+
+            for (size_t i = 0; i < dense_uids_.size(); ++i)
+            {
+               uid_to_index_.set(dense_uids_[i], i);
+            }
+         }
+
+         // Maps a batch of new UIDs to the dense indices after the last
+         // component and grows the columns to fit them. Returns false
+         // without changing the pool if any UID can't be added.
+         bool claimUids(Span<const uid_t> uids)
+         {
+            if (uids.size() > max_num_elements_ - size())
+            {
+               std::cout << "Couldn't add " << uids.size() << " components, the pool is too small\n";
+               return false;
+            }
+
+            const size_t first_index = size();
+            for (size_t i = 0; i < uids.size(); ++i)
+            {
+               if (uids[i] < 0 || uid_to_index_.get(uids[i]) != invalid_index_)
+               {
+                  std::cout << "Couldn't add UID " << uids[i] << " because it's negative or it already exists\n";
+                  for (size_t j = 0; j < i; ++j)
+                  {
+                     uid_to_index_.reset(uids[j]);
+                  }
+
+                  return false;
+               }
+
+               uid_to_index_.set(uids[i], first_index + i);
+            }
+
+            reserveColumns(first_index + uids.size());
+            dense_uids_.insert(dense_uids_.end(), uids.begin(), uids.end());
+
+            return true;
+         }
+
+         void scatter(size_t index, const Component_T & component)
+         {
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               columns_[i][index] = SoaTraits<Component_T>::getField(component, i);
+            }
+         }
+
+         void gather(size_t index, Component_T & component) const
+         {
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               SoaTraits<Component_T>::setField(component, i, columns_[i][index]);
+            }
+         }
+
+         // Grows every column so that it can hold at least 'num_elements'
+         // floats. Columns grow geometrically, and new space is zeroed.
+         void reserveColumns(size_t num_elements)
+         {
+            if (num_elements <= column_capacity_)
+            {
+               return;
+            }
+
+            size_t new_capacity = (column_capacity_ > 0) ? (2 * column_capacity_) : 64;
+            if (new_capacity < num_elements)
+            {
+               new_capacity = num_elements;
+            }
+
+            new_capacity = paddedSize(new_capacity);
+
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               float * new_column = static_cast<float *>(
+                  resource_->allocate(new_capacity * sizeof(float), soa_column_alignment)
+               );
+
+               if (new_column == nullptr)
+               {
+                  throw std::bad_alloc();
+               }
+
+               std::memset(new_column, 0, new_capacity * sizeof(float));
+
+               if (columns_[i] != nullptr)
+               {
+                  std::memcpy(new_column, columns_[i], dense_uids_.size() * sizeof(float));
+                  resource_->deallocate(
+                     columns_[i], column_capacity_ * sizeof(float), soa_column_alignment
+                  );
+               }
+
+               columns_[i] = new_column;
+            }
+
+            column_capacity_ = new_capacity;
+         }
+
+         void freeColumns(void)
+         {
+            for (size_t i = 0; i < num_fields; ++i)
+            {
+               if (columns_[i] != nullptr)
+               {
+                  resource_->deallocate(
+                     columns_[i], column_capacity_ * sizeof(float), soa_column_alignment
+                  );
+                  columns_[i] = nullptr;
+               }
+            }
+
+            column_capacity_ = 0;
+         }
+
+         ExternalUidSoaPool(void);
+
+         ExternalUidSoaPool(const ExternalUidSoaPool &);
+   };
+
+   template <typename Component_T>
+   const size_t ExternalUidSoaPool<Component_T>::num_fields;
+
+   template <typename Component_T>
+   const size_t ExternalUidSoaPool<Component_T>::invalid_index_;
+}
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef MEMORY_RESOURCE_HEADER
+#define MEMORY_RESOURCE_HEADER
+
+#include <cstddef>
+#include <vector>
+
+namespace trecs
+{
+   // An interface for the source of the memory that backs data pools, sparse
+   // arrays, and archetype chunks. Memory resources are never owned by the
+   // containers that allocate from them, so a resource must outlive every
+   // container that uses it.
+   class IMemoryResource
+   {
+      public:
+         virtual ~IMemoryResource(void) { };
+
+         // Returns a pointer to at least 'num_bytes' of memory aligned to
+         // 'alignment', which must be a power of two. Returns nullptr if the
+         // memory couldn't be allocated.
+         virtual void * allocate(size_t num_bytes, size_t alignment) = 0;
+
+         // Returns memory that was allocated by this resource with the same
+         // size and alignment.
+         virtual void deallocate(
+            void * ptr, size_t num_bytes, size_t alignment
+         ) = 0;
+
+         // Frees all of the memory allocated by this resource at once, if the
+         // resource supports it. Nothing allocated from the resource may be
+         // used after it's released.
+         virtual void release(void) = 0;
+   };
+
+   // Allocates every request individually with the global operator new.
+   class NewDeleteMemoryResource : public IMemoryResource
+   {
+      public:
+         void * allocate(size_t num_bytes, size_t alignment) override;
+
+         void deallocate(
+            void * ptr, size_t num_bytes, size_t alignment
+         ) override;
+
+         // Individual allocations can't be released all at once, so this
+         // does nothing.
+         void release(void) override
+         { }
+   };
+
+   // Returns the process-wide memory resource that's used by containers that
+   // aren't given a memory resource explicitly.
+   IMemoryResource * defaultMemoryResource(void);
+
+   // A bump allocator over one contiguous region of memory. Deallocating
+   // memory from the region does nothing, and all of it is reclaimed at once
+   // by 'release()'. Requests that don't fit in the region are forwarded to
+   // an upstream resource.
+   //
+   // On Linux the region is reserved with mmap and marked with
+   // madvise(MADV_HUGEPAGE) so that the kernel can back it with transparent
+   // huge pages. Physical memory is only committed as the region is touched.
+   class ArenaMemoryResource : public IMemoryResource
+   {
+      public:
+         ArenaMemoryResource(size_t capacity_bytes);
+
+         ArenaMemoryResource(
+            size_t capacity_bytes, IMemoryResource * upstream
+         );
+
+         ~ArenaMemoryResource(void) override;
+
+         void * allocate(size_t num_bytes, size_t alignment) override;
+
+         void deallocate(
+            void * ptr, size_t num_bytes, size_t alignment
+         ) override;
+
+         // Resets the arena to empty and frees all upstream allocations.
+         void release(void) override;
+
+         // The number of bytes in the arena's region.
+         size_t capacity(void) const
+         {
+            return capacity_bytes_;
+         }
+
+         // The number of bytes of the region that have been handed out,
+         // including alignment padding.
+         size_t bytesUsed(void) const
+         {
+            return offset_;
+         }
+
+         // The number of allocations that didn't fit in the region and were
+         // forwarded upstream.
+         size_t numUpstreamAllocations(void) const
+         {
+            return upstream_allocations_.size();
+         }
+
+         // True if the region was successfully marked as eligible for huge
+         // pages.
+         bool hugePages(void) const
+         {
+            return huge_pages_;
+         }
+
+         // Returns true if 'ptr' points into the arena's region.
+         bool owns(const void * ptr) const;
+
+      private:
+
+         typedef struct upstream_allocation_s
+         {
+            void * ptr;
+            size_t num_bytes;
+            size_t alignment;
+         } upstream_allocation_t;
+
+         IMemoryResource * upstream_;
+
+         size_t capacity_bytes_;
+
+         unsigned char * region_;
+
+         size_t offset_;
+
+         bool huge_pages_;
+
+         std::vector<upstream_allocation_t> upstream_allocations_;
+
+         void reserveRegion(void);
+
+         ArenaMemoryResource(void);
+
+         ArenaMemoryResource(const ArenaMemoryResource &);
+
+         ArenaMemoryResource & operator=(const ArenaMemoryResource &);
+   };
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef OBJECT_OPS_HEADER
+#define OBJECT_OPS_HEADER
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace trecs
+{
+   // Lifetime operations on ranges of objects in raw storage. Trivially
+   // copyable types are copied and moved with memcpy, and trivially
+   // destructible types skip destruction entirely. Every other type falls
+   // back to its constructors, assignment operators, and destructor.
+   template <typename Object_T>
+   class ObjectOps
+   {
+      public:
+         typedef std::integral_constant<
+            bool, std::is_trivially_copyable<Object_T>::value
+         > trivially_copyable_t;
+
+         typedef std::integral_constant<
+            bool, std::is_trivially_destructible<Object_T>::value
+         > trivially_destructible_t;
+
+         // Copy-constructs 'count' objects from 'src' into the raw storage at
+         // 'dest'. The two ranges must not overlap.
+         static void copyConstruct(Object_T * dest, const Object_T * src, size_t count)
+         {
+            copyConstruct(dest, src, count, trivially_copyable_t());
+         }
+
+         // Move-assigns the object at 'src' to the object at 'dest'.
+         static void moveAssign(Object_T * dest, Object_T * src)
+         {
+            moveAssign(dest, src, trivially_copyable_t());
+         }
+
+         // Destroys 'count' objects starting at 'first'.
+         static void destroy(Object_T * first, size_t count)
+         {
+            destroy(first, count, trivially_destructible_t());
+         }
+
+      private:
+
+         static void copyConstruct(
+            Object_T * dest, const Object_T * src, size_t count, std::true_type
+         )
+         {
+            if (count > 0)
+            {
+               std::memcpy(
+                  static_cast<void *>(dest),
+                  static_cast<const void *>(src),
+                  count * sizeof(Object_T)
+               );
+            }
+         }
+
+         static void copyConstruct(
+            Object_T * dest, const Object_T * src, size_t count, std::false_type
+         )
+         {
+            for (size_t i = 0; i < count; ++i)
+            {
+               new (dest + i) Object_T(src[i]);
+            }
+         }
+
+         static void moveAssign(Object_T * dest, Object_T * src, std::true_type)
+         {
+            std::memcpy(
+               static_cast<void *>(dest),
+               static_cast<const void *>(src),
+               sizeof(Object_T)
+            );
+         }
+
+         static void moveAssign(Object_T * dest, Object_T * src, std::false_type)
+         {
+            *dest = std::move(*src);
+         }
+
+         static void destroy(Object_T *, size_t, std::true_type)
+         { }
+
+         static void destroy(Object_T * first, size_t count, std::false_type)
+         {
+            for (size_t i = 0; i < count; ++i)
+            {
+               first[i].~Object_T();
+            }
+         }
+   };
+}
+
+#endif
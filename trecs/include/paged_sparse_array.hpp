@@ -0,0 +1,238 @@
+#ifndef PAGED_SPARSE_ARRAY_HEADER
+#define PAGED_SPARSE_ARRAY_HEADER
+
+#include "ecs_types.hpp"
+#include "memory_resource.hpp"
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace trecs
+{
+   // A sparse array indexed by UID. The array is split into fixed-size pages
+   // and a page is only allocated once a UID inside of its range is written
+   // to. Reads from UIDs that have never been written to return a default
+   // value without allocating anything.
+   //
+   //    E.g. With a page size of 4096, writing to UID 10000 allocates the
+   //    page that covers UIDs [8192, 12288) and nothing else.
+   template <typename Value_T, size_t PageSize = 4096>
+   class PagedSparseArray
+   {
+      static_assert(
+         (PageSize > 0) && ((PageSize & (PageSize - 1)) == 0),
+         "Page size must be a power of two"
+      );
+
+      public:
+         PagedSparseArray(const Value_T & default_value)
+            : default_value_(default_value)
+            , resource_(defaultMemoryResource())
+         { }
+
+         // Allocates pages from a memory resource. The resource must outlive
+         // the array.
+         PagedSparseArray(
+            const Value_T & default_value, IMemoryResource * resource
+         )
+            : default_value_(default_value)
+            , resource_(resource)
+         { }
+
+         PagedSparseArray(const PagedSparseArray<Value_T, PageSize> & other)
+            : default_value_(other.default_value_)
+            , resource_(other.resource_)
+         {
+            copyPages(other);
+         }
+
+         ~PagedSparseArray(void)
+         {
+            releasePages();
+         }
+
+         PagedSparseArray<Value_T, PageSize> & operator=(
+            const PagedSparseArray<Value_T, PageSize> & other
+         )
+         {
+            if (this == &other)
+            {
+               return *this;
+            }
+
+            releasePages();
+            default_value_ = other.default_value_;
+            copyPages(other);
+
+            return *this;
+         }
+
+         // Returns the value stored at a UID, or the default value if nothing
+         // has been written to that UID.
+         const Value_T & get(uid_t uid) const
+         {
+            if (uid < 0)
+            {
+               return default_value_;
+            }
+
+            const size_t page_index = static_cast<size_t>(uid) / PageSize;
+            if (page_index >= pages_.size() || pages_[page_index] == nullptr)
+            {
+               return default_value_;
+            }
+
+            return pages_[page_index][static_cast<size_t>(uid) % PageSize];
+         }
+
+         // Writes a value at a UID, allocating the UID's page if necessary.
+         // Writes to negative UIDs are ignored.
+         void set(uid_t uid, const Value_T & value)
+         {
+            if (uid < 0)
+            {
+               return;
+            }
+
+            getPage(static_cast<size_t>(uid) / PageSize)[static_cast<size_t>(uid) % PageSize] = value;
+         }
+
+         // Returns a reference to the value at a UID, allocating the UID's
+         // page if necessary. The UID must not be negative.
+         Value_T & at(uid_t uid)
+         {
+            return getPage(static_cast<size_t>(uid) / PageSize)[static_cast<size_t>(uid) % PageSize];
+         }
+
+         // Sets the value at a UID back to the default value. Does not
+         // allocate a page if the UID's page doesn't exist.
+         void reset(uid_t uid)
+         {
+            if (uid < 0)
+            {
+               return;
+            }
+
+            const size_t page_index = static_cast<size_t>(uid) / PageSize;
+            if (page_index >= pages_.size() || pages_[page_index] == nullptr)
+            {
+               return;
+            }
+
+            pages_[page_index][static_cast<size_t>(uid) % PageSize] = default_value_;
+         }
+
+         // Frees all of the pages.
+         void clear(void)
+         {
+            releasePages();
+         }
+
+         // Returns the number of pages that are currently allocated.
+         size_t numPages(void) const
+         {
+            size_t num_pages = 0;
+            for (const auto page : pages_)
+            {
+               num_pages += (page != nullptr);
+            }
+
+            return num_pages;
+         }
+
+         size_t pageSize(void) const
+         {
+            return PageSize;
+         }
+
+      private:
+
+         Value_T default_value_;
+
+         IMemoryResource * resource_;
+
+         // Pointers to pages of values. Pages that haven't been written to
+         // are null.
+         std::vector<Value_T *> pages_;
+
+         Value_T * getPage(size_t page_index)
+         {
+            if (page_index >= pages_.size())
+            {
+               pages_.resize(page_index + 1, nullptr);
+            }
+
+            if (pages_[page_index] == nullptr)
+            {
+               pages_[page_index] = allocatePage(default_value_);
+            }
+
+            return pages_[page_index];
+         }
+
+         void copyPages(const PagedSparseArray<Value_T, PageSize> & other)
+         {
+            pages_.resize(other.pages_.size(), nullptr);
+            for (size_t i = 0; i < other.pages_.size(); ++i)
+            {
+               if (other.pages_[i] == nullptr)
+               {
+                  continue;
+               }
+
+               pages_[i] = allocatePage(default_value_);
+               for (size_t j = 0; j < PageSize; ++j)
+               {
+                  pages_[i][j] = other.pages_[i][j];
+               }
+            }
+         }
+
+         // Allocates a page from the memory resource and fills it with a
+         // value.
+         Value_T * allocatePage(const Value_T & value)
+         {
+            Value_T * page = static_cast<Value_T *>(
+               resource_->allocate(PageSize * sizeof(Value_T), alignof(Value_T))
+            );
+
+            if (page == nullptr)
+            {
+               throw std::bad_alloc();
+            }
+
+            for (size_t i = 0; i < PageSize; ++i)
+            {
+               new (page + i) Value_T(value);
+            }
+
+            return page;
+         }
+
+         void releasePages(void)
+         {
+            for (auto & page : pages_)
+            {
+               if (page == nullptr)
+               {
+                  continue;
+               }
+
+               for (size_t i = 0; i < PageSize; ++i)
+               {
+                  page[i].~Value_T();
+               }
+
+               resource_->deallocate(
+                  page, PageSize * sizeof(Value_T), alignof(Value_T)
+               );
+               page = nullptr;
+            }
+
+            pages_.clear();
+         }
+   };
+}
+
+#endif
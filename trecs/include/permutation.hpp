@@ -0,0 +1,76 @@
+#ifndef PERMUTATION_HEADER
+#define PERMUTATION_HEADER
+
+#include <cstddef>
+#include <vector>
+
+namespace trecs
+{
+   // Builds an order for 'num_elements' dense elements that puts the
+   // elements at 'front_indices' first, in the given order, followed by
+   // every other element in its current order. Indices that are out of
+   // range or repeated are ignored.
+   inline std::vector<size_t> frontFirstOrder(
+      size_t num_elements, const std::vector<size_t> & front_indices
+   )
+   {
+      std::vector<size_t> order;
+      order.reserve(num_elements);
+
+      std::vector<bool> placed(num_elements, false);
+      for (const auto index : front_indices)
+      {
+         if (index >= num_elements || placed[index])
+         {
+            continue;
+         }
+
+         placed[index] = true;
+         order.push_back(index);
+      }
+
+      for (size_t i = 0; i < num_elements; ++i)
+      {
+         if (!placed[i])
+         {
+            order.push_back(i);
+         }
+      }
+
+      return order;
+   }
+
+   // Rearranges dense elements in place so that the element at index
+   // 'order[i]' ends up at index 'i'. Elements are moved by calling
+   // 'swap(a, b)' with pairs of indices, and every cycle of the permutation
+   // takes one fewer swap than its length.
+   template <typename Swap_T>
+   void applyPermutation(const std::vector<size_t> & order, Swap_T swap)
+   {
+      std::vector<bool> done(order.size(), false);
+
+      for (size_t i = 0; i < order.size(); ++i)
+      {
+         if (done[i])
+         {
+            continue;
+         }
+
+         size_t current = i;
+         while (true)
+         {
+            done[current] = true;
+            const size_t next = order[current];
+            if (next == i)
+            {
+               break;
+            }
+
+            swap(current, next);
+            current = next;
+         }
+      }
+   }
+}
+
+#endif
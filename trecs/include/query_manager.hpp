@@ -3,10 +3,13 @@
 
 #include "archetype.hpp"
 #include "ecs_types.hpp"
+#include "span.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <map>
-#include <unordered_set>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace trecs
@@ -15,85 +18,190 @@ namespace trecs
    {
       public:
 
+         QueryManager(void)
+            : signature_queries_(max_num_signatures)
+         { }
+
          query_t addArchetypeQuery(const DefaultArchetype & arch)
          {
-            if (archetypes_to_entities_.find(arch) == archetypes_to_entities_.end())
+            return addArchetypeQuery(arch, DefaultArchetype());
+         }
+
+         // Registers a query that matches entities whose archetypes include
+         // every signature in 'arch' and none of the signatures in
+         // 'excluded_arch'. Entities that already match are added to the new
+         // query. Returns the existing query ID if the same pair of
+         // archetypes was registered before.
+         query_t addArchetypeQuery(
+            const DefaultArchetype & arch,
+            const DefaultArchetype & excluded_arch
+         )
+         {
+            return addArchetypeQuery(
+               arch, excluded_arch, DefaultArchetype(), DefaultArchetype()
+            );
+         }
+
+         // Registers a query with change filters. Signatures in
+         // 'changed_arch' and 'added_arch' are required like the signatures
+         // in 'arch'; they don't change which entities match the query, only
+         // which matching entities are visited when iterating since a tick.
+         // Returns the existing query ID if the same archetypes were
+         // registered before.
+         query_t addArchetypeQuery(
+            const DefaultArchetype & arch,
+            const DefaultArchetype & excluded_arch,
+            const DefaultArchetype & changed_arch,
+            const DefaultArchetype & added_arch
+         )
+         {
+            query_key_t key;
+            key.arch = arch;
+            key.excluded_arch = excluded_arch;
+            key.changed_arch = changed_arch;
+            key.added_arch = added_arch;
+            for (signature_t sig = 0; sig < max_num_signatures; ++sig)
             {
-               archetypes_to_entities_[arch];
-               archetypes_.push_back(arch);
-               return archetypes_.size() - 1;
+               if (changed_arch.supports(sig) || added_arch.supports(sig))
+               {
+                  key.arch.mergeSignature(sig);
+               }
             }
 
-            for (query_t i = 0; i < archetypes_.size(); ++i)
+            const auto query_iter = archetype_queries_.find(key);
+            if (query_iter != archetype_queries_.end())
+            {
+               return query_iter->second;
+            }
+
+            const query_t query_id = archetypes_.size();
+            archetype_queries_[key] = query_id;
+            archetypes_.push_back(key.arch);
+            excluded_archetypes_.push_back(excluded_arch);
+            changed_archetypes_.push_back(changed_arch);
+            added_archetypes_.push_back(added_arch);
+            query_entities_.push_back(query_entities_t());
+
+            // Adding or removing an excluded signature changes membership as
+            // much as an included one, so both are indexed.
+            for (signature_t sig = 0; sig < max_num_signatures; ++sig)
             {
-               if (archetypes_[i] == arch)
+               if (key.arch.supports(sig) || excluded_arch.supports(sig))
                {
-                  return i;
+                  signature_queries_[sig].push_back(query_id);
                }
             }
 
-            return error_query;
+            addQueryToGraph(query_id);
+
+            return query_id;
          }
 
+         // Moves an entity between the queries of its old and new
+         // archetypes. Moves that add or remove one signature follow a cached
+         // edge of the archetype graph, so they only touch the queries that
+         // the entity enters or leaves.
          void moveEntity(
             trecs::uid_t entity,
             const DefaultArchetype & old_arch,
             const DefaultArchetype & new_arch
          )
          {
-            // Any incoming entity's archetype must have *at least* all of the
-            // bits in one of the stored archetypes in order to be added to the
-            // mapping.
-            // An incoming entity whose new archetype is the union of any two
-            // existing archetypes will be added to the mappings for both
-            // existing archetypes.
+            if (old_arch == new_arch)
+            {
+               return;
+            }
 
-            // An entity should be placed in every archetype slot whose
-            // archetype is a subset of the entity's archetype.
+            const size_t old_node = getNode(old_arch);
+
+            signature_t sig = error_signature;
+            if (differsBySignature(old_arch, new_arch, sig))
+            {
+               const archetype_edge_t & edge = getEdge(old_node, sig, new_arch);
+               applyEdge(entity, edge);
+               eraseNodeEntity(old_node, entity);
+               insertNodeEntity(edge.destination, entity);
+               return;
+            }
 
-            // New entities might have archetypes that are a subset of one or
-            // more existing archetypes. All existing archetypes are checked
-            // for the new entity's potential membership.
-            auto typed_entities_iter = archetypes_to_entities_.begin();
+            const size_t new_node = getNode(new_arch);
+            applyEdge(entity, makeEdge(old_node, new_node));
+            eraseNodeEntity(old_node, entity);
+            insertNodeEntity(new_node, entity);
+         }
 
-            for (
-               typed_entities_iter = archetypes_to_entities_.begin();
-               typed_entities_iter != archetypes_to_entities_.end();
-               ++typed_entities_iter
-            )
+         // Adds a batch of new entities that all have the same archetype. Only
+         // the queries that match the archetype are touched.
+         void addEntities(
+            const std::vector<trecs::uid_t> & entities,
+            const DefaultArchetype & arch
+         )
+         {
+            const size_t node = getNode(arch);
+            for (const auto entity : entities)
             {
-               if (typed_entities_iter->first.supports(old_arch))
-               {
-                  typed_entities_iter->second.erase(entity);
-               }
+               insertNodeEntity(node, entity);
+            }
+            for (const auto query_id : nodes_[node].queries)
+            {
+               insertEntities(query_entities_[query_id], entities);
+            }
+         }
+
+         // Removes a batch of entities that all have the same archetype. Only
+         // the queries that match the archetype are touched.
+         void removeEntities(
+            const std::vector<trecs::uid_t> & entities,
+            const DefaultArchetype & arch
+         )
+         {
+            const size_t node = getNode(arch);
+            for (const auto entity : entities)
+            {
+               eraseNodeEntity(node, entity);
             }
 
-            for (
-               typed_entities_iter = archetypes_to_entities_.begin();
-               typed_entities_iter != archetypes_to_entities_.end();
-               ++typed_entities_iter
-            )
+            for (const auto query_id : nodes_[node].queries)
             {
-               if (typed_entities_iter->first.supports(new_arch))
+               for (const auto entity : entities)
                {
-                  typed_entities_iter->second.insert(entity);
+                  eraseEntity(query_entities_[query_id], entity);
                }
             }
          }
 
+         // Removes an entity with a known archetype. Only the queries that
+         // match the archetype are touched.
+         void removeEntity(trecs::uid_t entity, const DefaultArchetype & arch)
+         {
+            const size_t node = getNode(arch);
+            eraseNodeEntity(node, entity);
+            for (const auto query_id : nodes_[node].queries)
+            {
+               eraseEntity(query_entities_[query_id], entity);
+            }
+         }
+
+         // Removes an entity without a known archetype, which checks every
+         // archetype and query.
          void removeEntity(trecs::uid_t entity)
          {
-            for (auto & typed_entities : archetypes_to_entities_)
+            for (size_t node = 0; node < nodes_.size(); ++node)
             {
-               typed_entities.second.erase(entity);
+               eraseNodeEntity(node, entity);
+            }
+
+            for (auto & query_entities : query_entities_)
+            {
+               eraseEntity(query_entities, entity);
             }
          }
 
          bool supportsArchetype(const DefaultArchetype & arch) const
          {
-            for (const auto & typed_entities : archetypes_to_entities_)
+            for (query_t i = 0; i < archetypes_.size(); ++i)
             {
-               if (typed_entities.first.supports(arch))
+               if (matches(i, arch))
                {
                   return true;
                }
@@ -101,29 +209,541 @@ namespace trecs
             return false;
          }
 
-         // Returns the set of entities associated with a valid query ID.
-         // Returns an empty set of entities if the query ID is invalid.
-         // Prints out a warning if the query ID is invalid.
-         auto getArchetypeEntities(
+         // Returns the archetype associated with a valid query ID. Returns an
+         // empty archetype if the query ID is invalid.
+         DefaultArchetype getArchetype(const query_t query_id) const
+         {
+            if (query_id >= archetypes_.size())
+            {
+               return DefaultArchetype();
+            }
+
+            return archetypes_[query_id];
+         }
+
+         // Returns the archetype of signatures that a valid query excludes.
+         // Returns an empty archetype if the query ID is invalid.
+         DefaultArchetype getExcludedArchetype(const query_t query_id) const
+         {
+            if (query_id >= excluded_archetypes_.size())
+            {
+               return DefaultArchetype();
+            }
+
+            return excluded_archetypes_[query_id];
+         }
+
+         // Returns the archetype of signatures whose components must have
+         // changed for a valid query to visit an entity. Returns an empty
+         // archetype if the query ID is invalid.
+         DefaultArchetype getChangedArchetype(const query_t query_id) const
+         {
+            if (query_id >= changed_archetypes_.size())
+            {
+               return DefaultArchetype();
+            }
+
+            return changed_archetypes_[query_id];
+         }
+
+         // Returns the archetype of signatures whose components must have
+         // been added for a valid query to visit an entity. Returns an empty
+         // archetype if the query ID is invalid.
+         DefaultArchetype getAddedArchetype(const query_t query_id) const
+         {
+            if (query_id >= added_archetypes_.size())
+            {
+               return DefaultArchetype();
+            }
+
+            return added_archetypes_[query_id];
+         }
+
+         // Returns the entities associated with a valid query ID as a
+         // contiguous span. Entities are kept in insertion order, except that
+         // removing an entity moves the last entity into its place. The span
+         // is invalidated by any change to the query's entities. Returns an
+         // empty span if the query ID is invalid, and prints out a warning.
+         Span<const trecs::uid_t> getArchetypeEntities(
             const query_t query_id
-         ) const -> const std::unordered_set<trecs::uid_t> &
+         ) const
          {
             if (query_id >= archetypes_.size())
             {
                std::cout << "Invalid query ID used to retrieve archetype entities\n";
-               return empty_set_;
+               return Span<const trecs::uid_t>();
             }
 
-            return archetypes_to_entities_.at(archetypes_.at(query_id));
+            const std::vector<trecs::uid_t> & entities = query_entities_[query_id].entities;
+            return Span<const trecs::uid_t>(entities.data(), entities.size());
+         }
+
+         // Returns true if the entity matches a valid query ID, false
+         // otherwise.
+         bool hasEntity(const query_t query_id, const trecs::uid_t entity) const
+         {
+            if (query_id >= archetypes_.size())
+            {
+               return false;
+            }
+
+            return query_entities_[query_id].positions.count(entity) > 0;
+         }
+
+         // Sorts a valid query's entities by UID so that iterating over them
+         // follows the order of components in sorted pools.
+         void sortEntities(const query_t query_id)
+         {
+            if (query_id >= archetypes_.size())
+            {
+               return;
+            }
+
+            query_entities_t & query_entities = query_entities_[query_id];
+            std::sort(query_entities.entities.begin(), query_entities.entities.end());
+
+            for (size_t i = 0; i < query_entities.entities.size(); ++i)
+            {
+               query_entities.positions[query_entities.entities[i]] = i;
+            }
+         }
+
+         // Returns the entities whose archetype is exactly 'arch' as a
+         // contiguous span. The span is invalidated by any change to the
+         // archetype's entities.
+         Span<const trecs::uid_t> getExactArchetypeEntities(
+            const DefaultArchetype & arch
+         ) const
+         {
+            const auto node_iter = node_ids_.find(arch);
+            if (node_iter == node_ids_.end())
+            {
+               return Span<const trecs::uid_t>();
+            }
+
+            const std::vector<trecs::uid_t> & entities = nodes_[node_iter->second].entities;
+            return Span<const trecs::uid_t>(entities.data(), entities.size());
+         }
+
+         // Returns the number of distinct archetypes in the archetype graph.
+         size_t numArchetypeNodes(void) const
+         {
+            return nodes_.size();
          }
 
       private:
 
-         std::map<DefaultArchetype, std::unordered_set<trecs::uid_t> > archetypes_to_entities_;
+         // The entities matching one query, stored densely with a map from
+         // each entity to its position so removal is a swap with the last
+         // entity.
+         struct query_entities_t
+         {
+            std::vector<trecs::uid_t> entities;
+
+            std::unordered_map<trecs::uid_t, size_t> positions;
+         };
+
+         // All of the archetypes that describe a query.
+         struct query_key_t
+         {
+            DefaultArchetype arch;
+            DefaultArchetype excluded_arch;
+            DefaultArchetype changed_arch;
+            DefaultArchetype added_arch;
+
+            bool operator<(const query_key_t & other) const
+            {
+               if (arch != other.arch)
+               {
+                  return arch < other.arch;
+               }
+               if (excluded_arch != other.excluded_arch)
+               {
+                  return excluded_arch < other.excluded_arch;
+               }
+               if (changed_arch != other.changed_arch)
+               {
+                  return changed_arch < other.changed_arch;
+               }
+               return added_arch < other.added_arch;
+            }
+         };
+
+         // The change in query membership when an entity moves from one
+         // archetype to another.
+         struct archetype_edge_t
+         {
+            signature_t sig;
+
+            size_t destination;
+
+            std::vector<query_t> added_queries;
+
+            std::vector<query_t> removed_queries;
+         };
+
+         // One distinct entity archetype, the entities that have exactly
+         // that archetype, the queries that match it, and the edges to the
+         // archetypes one signature away. Edges are built the first time an
+         // entity moves along them, and most archetypes only have a few, so
+         // they're searched linearly.
+         struct archetype_node_t
+         {
+            DefaultArchetype arch;
+
+            std::vector<trecs::uid_t> entities;
 
+            std::vector<query_t> queries;
+
+            std::vector<archetype_edge_t> edges;
+         };
+
+         // Maps each distinct query to its query ID.
+         std::map<query_key_t, query_t> archetype_queries_;
+
+         // Included archetypes, excluded archetypes, change filters, and
+         // matching entities, indexed by query ID.
          std::vector<DefaultArchetype> archetypes_;
 
-         std::unordered_set<trecs::uid_t> empty_set_;
+         std::vector<DefaultArchetype> excluded_archetypes_;
+
+         std::vector<DefaultArchetype> changed_archetypes_;
+
+         std::vector<DefaultArchetype> added_archetypes_;
+
+         std::vector<query_entities_t> query_entities_;
+
+         // Inverted index from each signature to the IDs of the queries whose
+         // included or excluded archetypes contain that signature.
+         std::vector<std::vector<query_t> > signature_queries_;
+
+         // The archetype graph, with a map from each archetype to its node.
+         std::vector<archetype_node_t> nodes_;
+
+         std::unordered_map<DefaultArchetype, size_t, DefaultArchetypeHash> node_ids_;
+
+         // The position of each entity in its node's entities, indexed by
+         // entity UID. An entity is only ever in one node, so one array
+         // covers every node.
+         std::vector<size_t> node_positions_;
+
+         bool matches(const query_t query_id, const DefaultArchetype & arch) const
+         {
+            return (
+               archetypes_[query_id].supports(arch) &&
+               !excluded_archetypes_[query_id].intersects(arch)
+            );
+         }
+
+         // Returns the node for an archetype, adding it to the graph if it's
+         // new. Only the queries that mention one of the archetype's
+         // signatures are checked against it.
+         size_t getNode(const DefaultArchetype & arch)
+         {
+            const auto node_iter = node_ids_.find(arch);
+            if (node_iter != node_ids_.end())
+            {
+               return node_iter->second;
+            }
+
+            std::vector<query_t> candidates;
+            for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+            {
+               if (arch.supports(sig))
+               {
+                  candidates.insert(
+                     candidates.end(),
+                     signature_queries_[sig].begin(),
+                     signature_queries_[sig].end()
+                  );
+               }
+            }
+
+            std::sort(candidates.begin(), candidates.end());
+            candidates.erase(
+               std::unique(candidates.begin(), candidates.end()),
+               candidates.end()
+            );
+
+            archetype_node_t node;
+            node.arch = arch;
+            for (const auto query_id : candidates)
+            {
+               if (matches(query_id, arch))
+               {
+                  node.queries.push_back(query_id);
+               }
+            }
+
+            return addNode(std::move(node));
+         }
+
+         size_t addNode(archetype_node_t && node)
+         {
+            const size_t node_id = nodes_.size();
+            node_ids_[node.arch] = node_id;
+            nodes_.push_back(std::move(node));
+
+            return node_id;
+         }
+
+         // Returns the cached edge from a node along a signature, building it
+         // if it hasn't been used before. 'dest_arch' is the node's archetype
+         // with 'sig' added or removed. Only the queries that mention 'sig'
+         // can be gained or lost along the edge, and a new destination node
+         // starts from the source node's queries.
+         const archetype_edge_t & getEdge(
+            const size_t node,
+            const signature_t sig,
+            const DefaultArchetype & dest_arch
+         )
+         {
+            for (const auto & edge : nodes_[node].edges)
+            {
+               if (edge.sig == sig)
+               {
+                  return edge;
+               }
+            }
+
+            archetype_edge_t edge;
+            edge.sig = sig;
+            for (const auto query_id : signature_queries_[sig])
+            {
+               const bool src_matches = matches(query_id, nodes_[node].arch);
+               const bool dest_matches = matches(query_id, dest_arch);
+               if (dest_matches && !src_matches)
+               {
+                  edge.added_queries.push_back(query_id);
+               }
+               else if (src_matches && !dest_matches)
+               {
+                  edge.removed_queries.push_back(query_id);
+               }
+            }
+
+            const auto node_iter = node_ids_.find(dest_arch);
+            if (node_iter != node_ids_.end())
+            {
+               edge.destination = node_iter->second;
+            }
+            else
+            {
+               archetype_node_t dest;
+               dest.arch = dest_arch;
+               for (const auto query_id : nodes_[node].queries)
+               {
+                  if (matches(query_id, dest_arch))
+                  {
+                     dest.queries.push_back(query_id);
+                  }
+               }
+               dest.queries.insert(
+                  dest.queries.end(),
+                  edge.added_queries.begin(),
+                  edge.added_queries.end()
+               );
+
+               // Adding the destination node can reallocate the graph, so
+               // the source node is looked up again afterwards.
+               edge.destination = addNode(std::move(dest));
+            }
+
+            nodes_[node].edges.push_back(std::move(edge));
+
+            return nodes_[node].edges.back();
+         }
+
+         archetype_edge_t makeEdge(const size_t src_node, const size_t dest_node) const
+         {
+            const archetype_node_t & src = nodes_[src_node];
+            const archetype_node_t & dest = nodes_[dest_node];
+
+            archetype_edge_t edge;
+            edge.destination = dest_node;
+
+            for (const auto query_id : dest.queries)
+            {
+               if (!matches(query_id, src.arch))
+               {
+                  edge.added_queries.push_back(query_id);
+               }
+            }
+
+            for (const auto query_id : src.queries)
+            {
+               if (!matches(query_id, dest.arch))
+               {
+                  edge.removed_queries.push_back(query_id);
+               }
+            }
+
+            return edge;
+         }
+
+         void applyEdge(const trecs::uid_t entity, const archetype_edge_t & edge)
+         {
+            for (const auto query_id : edge.removed_queries)
+            {
+               eraseEntity(query_entities_[query_id], entity);
+            }
+
+            for (const auto query_id : edge.added_queries)
+            {
+               insertEntity(query_entities_[query_id], entity);
+            }
+         }
+
+         // Adds a newly registered query to the cached query lists of every
+         // node and edge in the archetype graph, and backfills the query with
+         // the entities of the nodes it matches.
+         void addQueryToGraph(const query_t query_id)
+         {
+            std::vector<bool> node_matches(nodes_.size(), false);
+            for (size_t i = 0; i < nodes_.size(); ++i)
+            {
+               node_matches[i] = matches(query_id, nodes_[i].arch);
+               if (node_matches[i])
+               {
+                  nodes_[i].queries.push_back(query_id);
+                  insertEntities(query_entities_[query_id], nodes_[i].entities);
+               }
+            }
+
+            for (size_t i = 0; i < nodes_.size(); ++i)
+            {
+               for (auto & edge : nodes_[i].edges)
+               {
+                  if (node_matches[edge.destination] && !node_matches[i])
+                  {
+                     edge.added_queries.push_back(query_id);
+                  }
+                  else if (node_matches[i] && !node_matches[edge.destination])
+                  {
+                     edge.removed_queries.push_back(query_id);
+                  }
+               }
+            }
+         }
+
+         void insertNodeEntity(const size_t node, const trecs::uid_t entity)
+         {
+            if (entity < 0)
+            {
+               return;
+            }
+
+            if (static_cast<size_t>(entity) >= node_positions_.size())
+            {
+               node_positions_.resize(2 * static_cast<size_t>(entity) + 1);
+            }
+
+            node_positions_[entity] = nodes_[node].entities.size();
+            nodes_[node].entities.push_back(entity);
+         }
+
+         // Does nothing if the entity isn't in the node.
+         void eraseNodeEntity(const size_t node, const trecs::uid_t entity)
+         {
+            if ((entity < 0) || (static_cast<size_t>(entity) >= node_positions_.size()))
+            {
+               return;
+            }
+
+            std::vector<trecs::uid_t> & entities = nodes_[node].entities;
+            const size_t position = node_positions_[entity];
+            if ((position >= entities.size()) || (entities[position] != entity))
+            {
+               return;
+            }
+
+            const trecs::uid_t last_entity = entities.back();
+            entities[position] = last_entity;
+            node_positions_[last_entity] = position;
+            entities.pop_back();
+         }
+
+         // Returns true and sets 'sig' if two archetypes differ by exactly
+         // one signature, returns false otherwise.
+         static bool differsBySignature(
+            const DefaultArchetype & arch_a,
+            const DefaultArchetype & arch_b,
+            signature_t & sig
+         )
+         {
+            bool found = false;
+            for (int block = 0; block * 32 < max_num_signatures; ++block)
+            {
+               const uint32_t changed_bits = arch_a.at(block) ^ arch_b.at(block);
+               if (changed_bits == 0)
+               {
+                  continue;
+               }
+
+               if (found || ((changed_bits & (changed_bits - 1)) != 0))
+               {
+                  return false;
+               }
+
+               int bit = 0;
+               while ((changed_bits & (1u << bit)) == 0)
+               {
+                  ++bit;
+               }
+
+               sig = static_cast<signature_t>(block * 32 + bit);
+               found = true;
+            }
+
+            return found;
+         }
+
+         static void insertEntity(query_entities_t & query_entities, const trecs::uid_t entity)
+         {
+            const auto inserted = query_entities.positions.insert(
+               std::make_pair(entity, query_entities.entities.size())
+            );
+
+            if (inserted.second)
+            {
+               query_entities.entities.push_back(entity);
+            }
+         }
+
+         static void insertEntities(
+            query_entities_t & query_entities,
+            const std::vector<trecs::uid_t> & entities
+         )
+         {
+            query_entities.entities.reserve(
+               query_entities.entities.size() + entities.size()
+            );
+            query_entities.positions.reserve(
+               query_entities.positions.size() + entities.size()
+            );
+
+            for (const auto entity : entities)
+            {
+               insertEntity(query_entities, entity);
+            }
+         }
+
+         static void eraseEntity(query_entities_t & query_entities, const trecs::uid_t entity)
+         {
+            const auto position_iter = query_entities.positions.find(entity);
+            if (position_iter == query_entities.positions.end())
+            {
+               return;
+            }
+
+            const size_t position = position_iter->second;
+            const trecs::uid_t last_entity = query_entities.entities.back();
+
+            query_entities.entities[position] = last_entity;
+            query_entities.positions[last_entity] = position;
+            query_entities.entities.pop_back();
+            query_entities.positions.erase(position_iter);
+         }
 
    };
 
@@ -0,0 +1,174 @@
+#ifndef QUERY_TERMS_HEADER
+#define QUERY_TERMS_HEADER
+
+#include <type_traits>
+
+namespace trecs
+{
+   // Query term that matches entities that don't have a component type.
+   //
+   //    allocator.addArchetypeQuery<pos_t, Without<sleeping_t> >();
+   template <typename Component_T>
+   struct Without
+   { };
+
+   // Query term that doesn't affect which entities match a query. Views
+   // pass optional components as pointers that are null for entities that
+   // don't have the component.
+   //
+   //    allocator.view<pos_t, Optional<vel_t> >(query).each(
+   //       [](uid_t entity, pos_t & pos, vel_t * vel) { ... }
+   //    );
+   template <typename Component_T>
+   struct Optional
+   { };
+
+   // Query term that matches entities that have a component type, and
+   // filters iteration down to the entities whose component was added or
+   // written since a tick, see 'ChangeTicks'.
+   //
+   //    allocator.addArchetypeQuery<pos_t, Changed<vel_t> >();
+   template <typename Component_T>
+   struct Changed
+   { };
+
+   // Query term that matches entities that have a component type, and
+   // filters iteration down to the entities whose component was added since
+   // a tick, see 'ChangeTicks'.
+   template <typename Component_T>
+   struct Added
+   { };
+
+   typedef enum query_term
+   {
+      REQUIRED_TERM = 0,
+      EXCLUDED_TERM = 1,
+      OPTIONAL_TERM = 2,
+      CHANGED_TERM = 3,
+      ADDED_TERM = 4
+   } query_term_enum_t;
+
+   // Describes how one term of a query or view matches entities and how its
+   // component is passed to view functions. A plain component type is a
+   // required term. Views record a write to every component that's passed
+   // to them by non-const reference or pointer, so read-only view terms
+   // should be const.
+   template <typename Term_T>
+   struct QueryTerm
+   {
+      typedef Term_T component_t;
+
+      typedef Term_T & argument_t;
+
+      static const query_term_enum_t term = REQUIRED_TERM;
+
+      static const bool writes = true;
+
+      static bool missing(const Term_T * component)
+      {
+         return component == nullptr;
+      }
+
+      static argument_t argument(Term_T * component)
+      {
+         return *component;
+      }
+   };
+
+   template <typename Component_T>
+   struct QueryTerm<const Component_T>
+   {
+      typedef Component_T component_t;
+
+      typedef const Component_T & argument_t;
+
+      static const query_term_enum_t term = REQUIRED_TERM;
+
+      static const bool writes = false;
+
+      static bool missing(const Component_T * component)
+      {
+         return component == nullptr;
+      }
+
+      static argument_t argument(Component_T * component)
+      {
+         return *component;
+      }
+   };
+
+   template <typename Component_T>
+   struct QueryTerm<Without<Component_T> >
+   {
+      typedef Component_T component_t;
+
+      static const query_term_enum_t term = EXCLUDED_TERM;
+   };
+
+   template <typename Component_T>
+   struct QueryTerm<Optional<Component_T> >
+   {
+      typedef typename std::remove_const<Component_T>::type component_t;
+
+      typedef Component_T * argument_t;
+
+      static const query_term_enum_t term = OPTIONAL_TERM;
+
+      static const bool writes = !std::is_const<Component_T>::value;
+
+      static bool missing(const component_t *)
+      {
+         return false;
+      }
+
+      static argument_t argument(component_t * component)
+      {
+         return component;
+      }
+   };
+
+   template <typename Component_T>
+   struct QueryTerm<Changed<Component_T> >
+   {
+      typedef Component_T component_t;
+
+      static const query_term_enum_t term = CHANGED_TERM;
+   };
+
+   template <typename Component_T>
+   struct QueryTerm<Added<Component_T> >
+   {
+      typedef Component_T component_t;
+
+      static const query_term_enum_t term = ADDED_TERM;
+   };
+
+   template <typename Term_T>
+   const query_term_enum_t QueryTerm<Term_T>::term;
+
+   template <typename Term_T>
+   const bool QueryTerm<Term_T>::writes;
+
+   template <typename Component_T>
+   const query_term_enum_t QueryTerm<const Component_T>::term;
+
+   template <typename Component_T>
+   const bool QueryTerm<const Component_T>::writes;
+
+   template <typename Component_T>
+   const query_term_enum_t QueryTerm<Without<Component_T> >::term;
+
+   template <typename Component_T>
+   const query_term_enum_t QueryTerm<Optional<Component_T> >::term;
+
+   template <typename Component_T>
+   const bool QueryTerm<Optional<Component_T> >::writes;
+
+   template <typename Component_T>
+   const query_term_enum_t QueryTerm<Changed<Component_T> >::term;
+
+   template <typename Component_T>
+   const query_term_enum_t QueryTerm<Added<Component_T> >::term;
+}
+
+#endif
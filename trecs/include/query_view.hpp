@@ -0,0 +1,179 @@
+#ifndef QUERY_VIEW_HEADER
+#define QUERY_VIEW_HEADER
+
+#include "change_ticks.hpp"
+#include "component_array_wrapper.hpp"
+#include "ecs_types.hpp"
+#include "entity_manager.hpp"
+#include "query_terms.hpp"
+#include "span.hpp"
+
+#include <cstddef>
+#include <tuple>
+
+namespace trecs
+{
+   // A compile-time list of indices, used to expand a tuple into a list of
+   // function arguments.
+   template <size_t...Indices>
+   struct IndexList
+   { };
+
+   template <size_t N, size_t...Indices>
+   struct MakeIndexList
+      : MakeIndexList<N - 1, N - 1, Indices...>
+   { };
+
+   template <size_t...Indices>
+   struct MakeIndexList<0, Indices...>
+   {
+      typedef IndexList<Indices...> type;
+   };
+
+   // A typed view of the entities that match an archetype query. The
+   // component storage for every type is resolved once when the view is
+   // created, so visiting an entity's components doesn't look up any pools.
+   // View terms are component types, const component types, or 'Optional'
+   // component types. 'Without', 'Changed', and 'Added' terms belong in the
+   // query.
+   //
+   // Visiting an entity records a write to each of its components that's
+   // passed by non-const reference or pointer, see 'ChangeTicks'.
+   //
+   // The view is invalidated by adding or removing entities or components,
+   // so 'function' in 'each' shouldn't make structural changes.
+   template <typename...Terms>
+   class QueryView
+   {
+      static_assert(
+         sizeof...(Terms) > 0,
+         "Query views need at least one component type"
+      );
+
+      public:
+         // An empty view that visits nothing.
+         QueryView(void)
+            : entities_(nullptr)
+            , ticks_(nullptr)
+         { }
+
+         // 'sigs' holds the component signature of every term, in order.
+         QueryView(
+            Span<const uid_t> uids,
+            const EntityManager * entities,
+            ChangeTicks * ticks,
+            const ChangeFilter & filter,
+            const signature_t * sigs,
+            ComponentArrayWrapper<typename QueryTerm<Terms>::component_t>...components
+         )
+            : uids_(uids)
+            , entities_(entities)
+            , ticks_(ticks)
+            , filter_(filter)
+            , components_(components...)
+         {
+            for (size_t i = 0; i < sizeof...(Terms); ++i)
+            {
+               sigs_[i] = sigs[i];
+            }
+         }
+
+         // Returns the number of entities that match the view's query,
+         // including disabled entities and entities that the query's change
+         // filters skip.
+         size_t size(void) const
+         {
+            return uids_.size();
+         }
+
+         bool empty(void) const
+         {
+            return uids_.empty();
+         }
+
+         // Calls 'function(uid, component_a, component_b, ...)' for every
+         // enabled entity in the view that passes the query's change
+         // filters, in query order. Components are passed by reference,
+         // optional components are passed by pointer.
+         template <typename Function_T>
+         void each(Function_T function)
+         {
+            eachEntity(
+               function,
+               typename MakeIndexList<sizeof...(Terms)>::type()
+            );
+         }
+
+      private:
+
+         Span<const uid_t> uids_;
+
+         const EntityManager * entities_;
+
+         ChangeTicks * ticks_;
+
+         ChangeFilter filter_;
+
+         signature_t sigs_[sizeof...(Terms)];
+
+         std::tuple<
+            ComponentArrayWrapper<typename QueryTerm<Terms>::component_t>...
+         > components_;
+
+         template <typename Function_T, size_t...Indices>
+         void eachEntity(Function_T & function, IndexList<Indices...>)
+         {
+            // Entities are only checked individually if some are disabled or
+            // if the query has change filters.
+            const bool skip_disabled = (entities_ != nullptr) && (entities_->numDisabled() > 0);
+            const bool filter_changes = !filter_.empty();
+
+            for (const auto uid : uids_)
+            {
+               if (skip_disabled && !entities_->entityEnabled(uid))
+               {
+                  continue;
+               }
+
+               if (filter_changes && !filter_.passes(*ticks_, uid))
+               {
+                  continue;
+               }
+
+               visit(function, uid, std::get<Indices>(components_)[uid]...);
+            }
+         }
+
+         template <typename Function_T>
+         void visit(
+            Function_T & function,
+            const uid_t uid,
+            typename QueryTerm<Terms>::component_t *...components
+         )
+         {
+            const bool missing[] = {QueryTerm<Terms>::missing(components)...};
+            for (const auto component_missing : missing)
+            {
+               if (component_missing)
+               {
+                  return;
+               }
+            }
+
+            function(uid, QueryTerm<Terms>::argument(components)...);
+
+            const bool written[] = {
+               QueryTerm<Terms>::writes && (components != nullptr)...
+            };
+            for (size_t i = 0; i < sizeof...(Terms); ++i)
+            {
+               if (written[i])
+               {
+                  ticks_->markChanged(sigs_[i], uid);
+               }
+            }
+         }
+   };
+}
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef SPAN_HEADER
+#define SPAN_HEADER
+
+#include <cstddef>
+
+namespace trecs
+{
+   // A non-owning view of a contiguous range of elements. The view is only
+   // valid as long as the underlying storage isn't resized or freed.
+   template <typename T>
+   class Span
+   {
+      public:
+         Span(void)
+            : data_(nullptr)
+            , size_(0)
+         { }
+
+         Span(T * data, size_t size)
+            : data_(data)
+            , size_(size)
+         { }
+
+         T * data(void) const
+         {
+            return data_;
+         }
+
+         size_t size(void) const
+         {
+            return size_;
+         }
+
+         bool empty(void) const
+         {
+            return size_ == 0;
+         }
+
+         T & operator[](size_t i) const
+         {
+            return data_[i];
+         }
+
+         T * begin(void) const
+         {
+            return data_;
+         }
+
+         T * end(void) const
+         {
+            return data_ + size_;
+         }
+
+      private:
+
+         T * data_;
+
+         size_t size_;
+   };
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef UID_RESERVATION_HEADER
+#define UID_RESERVATION_HEADER
+
+#include "ecs_types.hpp"
+
+#include <cstddef>
+
+namespace trecs
+{
+   // A contiguous range of entity UIDs reserved from an entity manager. A
+   // reservation is owned by one thread, which takes UIDs from it without
+   // any synchronization. The entity manager itself isn't touched until the
+   // UIDs are added as entities or the reservation is released.
+   //
+   //    E.g. The main thread reserves a block of UIDs for every job, each job
+   //    takes UIDs for the entities it wants to create, and the main thread
+   //    adds those entities and releases the reservations after the jobs
+   //    have finished.
+   class UidReservation
+   {
+      public:
+         UidReservation(void)
+            : next_uid_(0)
+            , end_uid_(0)
+         { }
+
+         // Reserves the UIDs in [first_uid, end_uid).
+         UidReservation(uid_t first_uid, uid_t end_uid)
+            : next_uid_(first_uid)
+            , end_uid_(end_uid)
+         { }
+
+         // Returns the next UID in the reservation, or -1 if every UID has
+         // been taken.
+         uid_t takeUid(void)
+         {
+            return (next_uid_ < end_uid_) ? next_uid_++ : -1;
+         }
+
+         // Returns the number of UIDs that haven't been taken.
+         size_t remaining(void) const
+         {
+            return static_cast<size_t>(end_uid_ - next_uid_);
+         }
+
+         bool empty(void) const
+         {
+            return next_uid_ >= end_uid_;
+         }
+
+         // The first UID that hasn't been taken.
+         uid_t nextUid(void) const
+         {
+            return next_uid_;
+         }
+
+         // One past the last UID in the reservation.
+         uid_t endUid(void) const
+         {
+            return end_uid_;
+         }
+
+      private:
+
+         uid_t next_uid_;
+
+         uid_t end_uid_;
+   };
+}
+
+#endif
@@ -1,24 +1,33 @@
 #include "allocator.hpp"
 
+#include <algorithm>
+#include <map>
+
 namespace trecs
 {
 
    Allocator::Allocator(void)
-      : max_num_entities_(20000)
-      , entities_(max_num_entities_)
-      , components_(max_num_entities_)
-   {
-      registerComponent<trecs::edge_t>();
-      edge_query_ = addArchetypeQuery<trecs::edge_t>();
-
-      registerComponent<EntityComponentBuffer>();
-      ecb_query_ = addArchetypeQuery<EntityComponentBuffer>();
-   }
+      : Allocator(20000, PER_TYPE_POOLS)
+   { }
 
    Allocator::Allocator(unsigned int max_num_entities)
+      : Allocator(max_num_entities, PER_TYPE_POOLS)
+   { }
+
+   Allocator::Allocator(
+      unsigned int max_num_entities, component_storage_enum_t storage
+   )
+      : Allocator(max_num_entities, storage, defaultMemoryResource())
+   { }
+
+   Allocator::Allocator(
+      unsigned int max_num_entities,
+      component_storage_enum_t storage,
+      IMemoryResource * resource
+   )
       : max_num_entities_(max_num_entities)
       , entities_(max_num_entities_)
-      , components_(max_num_entities_)
+      , components_(max_num_entities_, storage, resource)
    {
       registerComponent<trecs::edge_t>();
       edge_query_ = addArchetypeQuery<trecs::edge_t>();
@@ -63,10 +72,76 @@ namespace trecs
 
    void Allocator::removeEntity(uid_t entity_uid)
    {
+      if (!entities_.entityActive(entity_uid))
+      {
+         return;
+      }
+
+      const DefaultArchetype arch = entities_.getArchetype(entity_uid);
       entities_.removeEntity(entity_uid);
       components_.removeComponents(entity_uid);
       removeNodeEntityFromEdge(entity_uid);
-      queries_.removeEntity(entity_uid);
+      queries_.removeEntity(entity_uid, arch);
+   }
+
+   void Allocator::removeEntities(Span<const uid_t> entity_uids)
+   {
+      std::map<DefaultArchetype, std::vector<uid_t> > entities_by_archetype;
+      std::unordered_set<uid_t> removed_entities;
+
+      // Entities are deactivated as they're grouped, so repeated UIDs are
+      // skipped as inactive.
+      for (const auto entity_uid : entity_uids)
+      {
+         if (!entities_.entityActive(entity_uid))
+         {
+            continue;
+         }
+
+         entities_by_archetype[entities_.getArchetype(entity_uid)].push_back(entity_uid);
+         removed_entities.insert(entity_uid);
+         entities_.removeEntity(entity_uid);
+      }
+
+      for (const auto & archetype_entities : entities_by_archetype)
+      {
+         const std::vector<uid_t> & entities = archetype_entities.second;
+         components_.removeComponents(
+            Span<const uid_t>(entities.data(), entities.size()),
+            archetype_entities.first
+         );
+         queries_.removeEntities(entities, archetype_entities.first);
+      }
+
+      if (!removed_entities.empty())
+      {
+         removeNodeEntitiesFromEdges(removed_entities);
+      }
+   }
+
+   void Allocator::removeEntities(const query_t arch_query)
+   {
+      // The query's entities shrink as entities are removed, so they're
+      // copied first.
+      const auto query_entities = queries_.getArchetypeEntities(arch_query);
+      const std::vector<uid_t> entities(query_entities.begin(), query_entities.end());
+
+      removeEntities(Span<const uid_t>(entities.data(), entities.size()));
+   }
+
+   entity_handle_t Allocator::getEntityHandle(uid_t entity_uid) const
+   {
+      return entities_.getHandle(entity_uid);
+   }
+
+   bool Allocator::entityHandleValid(entity_handle_t handle) const
+   {
+      return entities_.handleValid(handle);
+   }
+
+   uid_t Allocator::getEntityUid(entity_handle_t handle) const
+   {
+      return entities_.handleValid(handle) ? handle.uid() : -1;
    }
 
    edge_t Allocator::getEdge(uid_t edge_entity_uid)
@@ -127,7 +202,7 @@ namespace trecs
    void Allocator::removeNodeEntityFromEdge(uid_t entity_uid)
    {
       auto edges = getComponents<trecs::edge_t>();
-      const auto & edge_entities = getQueryEntities(edge_query_);
+      const auto edge_entities = getQueryEntities(edge_query_);
 
       for (auto & entity : edge_entities)
       {
@@ -146,19 +221,66 @@ namespace trecs
             temp_edge->nodeIdB = -1;
          }
 
-         if (temp_edge->nodeIdA == -1 && temp_edge->nodeIdB == -1)
+         updateEdgeFlag(*temp_edge);
+      }
+   }
+
+   void Allocator::removeNodeEntitiesFromEdges(
+      const std::unordered_set<uid_t> & entity_uids
+   )
+   {
+      auto edges = getComponents<trecs::edge_t>();
+      const auto edge_entities = getQueryEntities(edge_query_);
+
+      for (auto & entity : edge_entities)
+      {
+         trecs::edge_t * temp_edge = edges[entity];
+         if (temp_edge == nullptr)
          {
-            temp_edge->flag = trecs::edge_flag_enum_t::NULL_EDGE;
+            continue;
          }
-         else if (temp_edge->nodeIdA == -1 && temp_edge->nodeIdB > -1)
+
+         if (entity_uids.count(temp_edge->nodeIdA) > 0)
          {
-            temp_edge->flag = trecs::edge_flag_enum_t::NODE_A_TERMINAL;
+            temp_edge->nodeIdA = -1;
          }
-         else if (temp_edge->nodeIdA > -1 && temp_edge->nodeIdB == -1)
+         if (entity_uids.count(temp_edge->nodeIdB) > 0)
          {
-            temp_edge->flag = trecs::edge_flag_enum_t::NODE_B_TERMINAL;
+            temp_edge->nodeIdB = -1;
          }
+
+         updateEdgeFlag(*temp_edge);
+      }
+   }
+
+   void Allocator::updateEdgeFlag(edge_t & edge)
+   {
+      if (edge.nodeIdA == -1 && edge.nodeIdB == -1)
+      {
+         edge.flag = trecs::edge_flag_enum_t::NULL_EDGE;
       }
+      else if (edge.nodeIdA == -1 && edge.nodeIdB > -1)
+      {
+         edge.flag = trecs::edge_flag_enum_t::NODE_A_TERMINAL;
+      }
+      else if (edge.nodeIdA > -1 && edge.nodeIdB == -1)
+      {
+         edge.flag = trecs::edge_flag_enum_t::NODE_B_TERMINAL;
+      }
+   }
+
+   size_t Allocator::sortByQuery(const query_t arch_query)
+   {
+      // The query's entities are sorted too, so iterating over the query
+      // walks the sorted pools front to back.
+      queries_.sortEntities(arch_query);
+      const auto query_entities = queries_.getArchetypeEntities(arch_query);
+
+      std::vector<uid_t> entities(query_entities.begin(), query_entities.end());
+
+      components_.sortByQuery(queries_.getArchetype(arch_query), entities);
+
+      return entities.size();
    }
 
    void Allocator::initializeSystems(void)
@@ -0,0 +1,557 @@
+#include "archetype_chunk_store.hpp"
+
+#include <cassert>
+#include <iostream>
+
+namespace trecs
+{
+   ArchetypeChunk::ArchetypeChunk(const ArchetypeTable & table)
+      : table_(table)
+      , size_(0)
+      , bytes_(nullptr)
+   {
+      bytes_ = static_cast<unsigned char *>(
+         table_.resource_->allocate(table_.chunkSizeBytes(), table_.alignment())
+      );
+
+      if (bytes_ == nullptr)
+      {
+         throw std::bad_alloc();
+      }
+   }
+
+   ArchetypeChunk::~ArchetypeChunk(void)
+   {
+      table_.resource_->deallocate(
+         bytes_, table_.chunkSizeBytes(), table_.alignment()
+      );
+      bytes_ = nullptr;
+   }
+
+   const DefaultArchetype & ArchetypeChunk::archetype(void) const
+   {
+      return table_.archetype();
+   }
+
+   size_t ArchetypeChunk::capacity(void) const
+   {
+      return table_.rowsPerChunk();
+   }
+
+   void * ArchetypeChunk::column(signature_t sig)
+   {
+      if (sig >= max_num_signatures || !table_.hasColumn(sig))
+      {
+         return nullptr;
+      }
+
+      return bytes_ + table_.column_offsets_[sig];
+   }
+
+   const void * ArchetypeChunk::column(signature_t sig) const
+   {
+      if (sig >= max_num_signatures || !table_.hasColumn(sig))
+      {
+         return nullptr;
+      }
+
+      return bytes_ + table_.column_offsets_[sig];
+   }
+
+   ArchetypeTable::ArchetypeTable(
+      const DefaultArchetype & arch,
+      const column_type_t * column_types,
+      size_t chunk_size_bytes,
+      IMemoryResource * resource
+   )
+      : archetype_(arch)
+      , column_types_(column_types)
+      , resource_(resource)
+      , chunk_size_bytes_(chunk_size_bytes)
+      , alignment_(alignof(uid_t))
+      , rows_per_chunk_(0)
+      , size_(0)
+   {
+      for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+      {
+         column_offsets_[sig] = invalid_offset_;
+
+         if (archetype_.supports(sig))
+         {
+            signatures_.push_back(sig);
+            if (column_types_[sig].alignment > alignment_)
+            {
+               alignment_ = column_types_[sig].alignment;
+            }
+         }
+      }
+
+      size_t row_size_bytes = sizeof(uid_t);
+      for (const auto sig : signatures_)
+      {
+         row_size_bytes += column_types_[sig].size;
+      }
+
+      // Fit as many rows as possible into the chunk, accounting for the
+      // padding between columns.
+      rows_per_chunk_ = chunk_size_bytes_ / row_size_bytes;
+      while (
+         (rows_per_chunk_ > 1) &&
+         (layoutColumns(rows_per_chunk_) > chunk_size_bytes_)
+      )
+      {
+         --rows_per_chunk_;
+      }
+
+      // Very large components get one row per chunk, and the chunk grows to
+      // fit the row.
+      if (rows_per_chunk_ == 0)
+      {
+         rows_per_chunk_ = 1;
+      }
+
+      const size_t required_bytes = layoutColumns(rows_per_chunk_);
+      if (required_bytes > chunk_size_bytes_)
+      {
+         chunk_size_bytes_ = required_bytes;
+      }
+   }
+
+   ArchetypeTable::~ArchetypeTable(void)
+   {
+      while (size_ > 0)
+      {
+         removeRow(size_ - 1);
+      }
+
+      for (auto & chunk : chunks_)
+      {
+         delete chunk;
+         chunk = nullptr;
+      }
+   }
+
+   size_t ArchetypeTable::appendRow(uid_t entity)
+   {
+      if (size_ == chunks_.size() * rows_per_chunk_)
+      {
+         chunks_.push_back(new ArchetypeChunk(*this));
+      }
+
+      const size_t row = size_;
+      ArchetypeChunk * chunk = chunks_[row / rows_per_chunk_];
+      const size_t chunk_row = row % rows_per_chunk_;
+
+      *(chunk->uidAt(chunk_row)) = entity;
+
+      for (const auto sig : signatures_)
+      {
+         column_types_[sig].construct(
+            chunk->componentAt(
+               column_offsets_[sig], column_types_[sig].size, chunk_row
+            )
+         );
+      }
+
+      ++chunk->size_;
+      ++size_;
+
+      return row;
+   }
+
+   uid_t ArchetypeTable::removeRow(size_t row)
+   {
+      assert(row < size_);
+
+      const size_t last_row = size_ - 1;
+      ArchetypeChunk * last_chunk = chunks_[last_row / rows_per_chunk_];
+      const size_t last_chunk_row = last_row % rows_per_chunk_;
+
+      uid_t moved_entity = -1;
+
+      if (row != last_row)
+      {
+         ArchetypeChunk * chunk = chunks_[row / rows_per_chunk_];
+         const size_t chunk_row = row % rows_per_chunk_;
+
+         moved_entity = *(last_chunk->uidAt(last_chunk_row));
+         *(chunk->uidAt(chunk_row)) = moved_entity;
+
+         for (const auto sig : signatures_)
+         {
+            column_types_[sig].move(
+               chunk->componentAt(
+                  column_offsets_[sig], column_types_[sig].size, chunk_row
+               ),
+               last_chunk->componentAt(
+                  column_offsets_[sig], column_types_[sig].size, last_chunk_row
+               )
+            );
+         }
+      }
+
+      for (const auto sig : signatures_)
+      {
+         column_types_[sig].destroy(
+            last_chunk->componentAt(
+               column_offsets_[sig], column_types_[sig].size, last_chunk_row
+            )
+         );
+      }
+
+      --last_chunk->size_;
+      --size_;
+
+      // Free the last chunk once it's empty.
+      if (last_chunk->size_ == 0)
+      {
+         delete last_chunk;
+         chunks_.pop_back();
+      }
+
+      return moved_entity;
+   }
+
+   void ArchetypeTable::moveRowFrom(
+      ArchetypeTable & src_table, size_t src_row, size_t dest_row
+   )
+   {
+      for (const auto sig : src_table.signatures_)
+      {
+         if (!hasColumn(sig))
+         {
+            continue;
+         }
+
+         column_types_[sig].move(
+            component(dest_row, sig), src_table.component(src_row, sig)
+         );
+      }
+   }
+
+   void * ArchetypeTable::component(size_t row, signature_t sig)
+   {
+      if (sig >= max_num_signatures || !hasColumn(sig) || row >= size_)
+      {
+         return nullptr;
+      }
+
+      return chunks_[row / rows_per_chunk_]->componentAt(
+         column_offsets_[sig], column_types_[sig].size, row % rows_per_chunk_
+      );
+   }
+
+   const void * ArchetypeTable::component(size_t row, signature_t sig) const
+   {
+      if (sig >= max_num_signatures || !hasColumn(sig) || row >= size_)
+      {
+         return nullptr;
+      }
+
+      return chunks_[row / rows_per_chunk_]->componentAt(
+         column_offsets_[sig], column_types_[sig].size, row % rows_per_chunk_
+      );
+   }
+
+   size_t ArchetypeTable::layoutColumns(size_t num_rows)
+   {
+      // The UID column is always first.
+      size_t offset = num_rows * sizeof(uid_t);
+
+      for (const auto sig : signatures_)
+      {
+         const size_t alignment = column_types_[sig].alignment;
+         offset = ((offset + alignment - 1) / alignment) * alignment;
+         column_offsets_[sig] = offset;
+         offset += num_rows * column_types_[sig].size;
+      }
+
+      return offset;
+   }
+
+   ArchetypeChunkStore::ArchetypeChunkStore(void)
+      : ArchetypeChunkStore(default_chunk_size_bytes, defaultMemoryResource())
+   { }
+
+   ArchetypeChunkStore::ArchetypeChunkStore(size_t chunk_size_bytes)
+      : ArchetypeChunkStore(chunk_size_bytes, defaultMemoryResource())
+   { }
+
+   ArchetypeChunkStore::ArchetypeChunkStore(
+      size_t chunk_size_bytes, IMemoryResource * resource
+   )
+      : chunk_size_bytes_(chunk_size_bytes)
+      , resource_(resource)
+      , locations_(entity_location_t{-1, 0}, resource)
+   {
+      initialize();
+   }
+
+   ArchetypeChunkStore::~ArchetypeChunkStore(void)
+   {
+      clear();
+   }
+
+   void * ArchetypeChunkStore::addComponent(uid_t entity, signature_t sig)
+   {
+      if (sig >= max_num_signatures || !registered_[sig])
+      {
+         std::cout << "Couldn't find column for signature " << static_cast<int>(sig) << "\n";
+         return nullptr;
+      }
+
+      const entity_location_t location = locations_.get(entity);
+
+      DefaultArchetype new_arch;
+      if (location.table >= 0)
+      {
+         new_arch = tables_[location.table]->archetype();
+      }
+
+      if (new_arch.supports(sig))
+      {
+         std::cout << "Couldn't add UID " << entity << " because it already exists\n";
+         return nullptr;
+      }
+
+      new_arch.mergeSignature(sig);
+      moveEntity(entity, new_arch);
+
+      return getComponent(entity, sig);
+   }
+
+   bool ArchetypeChunkStore::addEntities(
+      Span<const uid_t> entities, const DefaultArchetype & arch
+   )
+   {
+      DefaultArchetype table_arch;
+      for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+      {
+         if (arch.supports(sig) && registered_[sig])
+         {
+            table_arch.mergeSignature(sig);
+         }
+      }
+
+      if (table_arch.empty())
+      {
+         return true;
+      }
+
+      for (const auto entity : entities)
+      {
+         if (locations_.get(entity).table >= 0)
+         {
+            std::cout << "Couldn't add UID " << entity << " because it already exists\n";
+            return false;
+         }
+      }
+
+      entity_location_t location;
+      location.table = getOrCreateTable(table_arch);
+
+      for (const auto entity : entities)
+      {
+         location.row = tables_[location.table]->appendRow(entity);
+         locations_.set(entity, location);
+      }
+
+      return true;
+   }
+
+   void ArchetypeChunkStore::removeComponent(uid_t entity, signature_t sig)
+   {
+      const entity_location_t location = locations_.get(entity);
+
+      if (location.table < 0 || !tables_[location.table]->archetype().supports(sig))
+      {
+         return;
+      }
+
+      DefaultArchetype new_arch = tables_[location.table]->archetype();
+      new_arch.removeSignature(sig);
+      moveEntity(entity, new_arch);
+   }
+
+   void ArchetypeChunkStore::removeComponents(uid_t entity)
+   {
+      const entity_location_t location = locations_.get(entity);
+
+      if (location.table < 0)
+      {
+         return;
+      }
+
+      removeRow(location.table, location.row);
+      locations_.reset(entity);
+   }
+
+   void * ArchetypeChunkStore::getComponent(uid_t entity, signature_t sig)
+   {
+      const entity_location_t location = locations_.get(entity);
+
+      if (location.table < 0)
+      {
+         return nullptr;
+      }
+
+      return tables_[location.table]->component(location.row, sig);
+   }
+
+   const void * ArchetypeChunkStore::getComponent(uid_t entity, signature_t sig) const
+   {
+      const entity_location_t location = locations_.get(entity);
+
+      if (location.table < 0)
+      {
+         return nullptr;
+      }
+
+      const ArchetypeTable * table = tables_[location.table];
+      return table->component(location.row, sig);
+   }
+
+   size_t ArchetypeChunkStore::numComponents(signature_t sig) const
+   {
+      size_t num_components = 0;
+      for (const auto table : tables_)
+      {
+         if (table->archetype().supports(sig))
+         {
+            num_components += table->size();
+         }
+      }
+
+      return num_components;
+   }
+
+   std::vector<uid_t> ArchetypeChunkStore::getComponentEntities(
+      signature_t sig
+   ) const
+   {
+      std::vector<uid_t> entities;
+      for (const auto table : tables_)
+      {
+         if (!table->archetype().supports(sig))
+         {
+            continue;
+         }
+
+         for (const auto chunk : table->chunks())
+         {
+            const Span<const uid_t> uids = chunk->uids();
+            entities.insert(entities.end(), uids.begin(), uids.end());
+         }
+      }
+
+      return entities;
+   }
+
+   std::vector<ArchetypeChunk *> ArchetypeChunkStore::getChunks(
+      const DefaultArchetype & query_arch
+   ) const
+   {
+      return getChunks(query_arch, DefaultArchetype());
+   }
+
+   std::vector<ArchetypeChunk *> ArchetypeChunkStore::getChunks(
+      const DefaultArchetype & query_arch,
+      const DefaultArchetype & excluded_arch
+   ) const
+   {
+      std::vector<ArchetypeChunk *> chunks;
+      for (const auto table : tables_)
+      {
+         if (
+            !query_arch.supports(table->archetype()) ||
+            excluded_arch.intersects(table->archetype())
+         )
+         {
+            continue;
+         }
+
+         chunks.insert(
+            chunks.end(), table->chunks().begin(), table->chunks().end()
+         );
+      }
+
+      return chunks;
+   }
+
+   void ArchetypeChunkStore::clear(void)
+   {
+      for (auto & table : tables_)
+      {
+         delete table;
+         table = nullptr;
+      }
+
+      tables_.clear();
+      archetypes_to_tables_.clear();
+      locations_.clear();
+   }
+
+   void ArchetypeChunkStore::initialize(void)
+   {
+      for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+      {
+         registered_[sig] = false;
+      }
+   }
+
+   size_t ArchetypeChunkStore::getOrCreateTable(const DefaultArchetype & arch)
+   {
+      const auto table_iter = archetypes_to_tables_.find(arch);
+      if (table_iter != archetypes_to_tables_.end())
+      {
+         return table_iter->second;
+      }
+
+      tables_.push_back(
+         new ArchetypeTable(arch, column_types_, chunk_size_bytes_, resource_)
+      );
+      archetypes_to_tables_[arch] = tables_.size() - 1;
+
+      return tables_.size() - 1;
+   }
+
+   void ArchetypeChunkStore::moveEntity(
+      uid_t entity, const DefaultArchetype & new_arch
+   )
+   {
+      const entity_location_t old_location = locations_.get(entity);
+
+      if (new_arch.empty())
+      {
+         removeComponents(entity);
+         return;
+      }
+
+      entity_location_t new_location;
+      new_location.table = getOrCreateTable(new_arch);
+      new_location.row = tables_[new_location.table]->appendRow(entity);
+
+      if (old_location.table >= 0)
+      {
+         tables_[new_location.table]->moveRowFrom(
+            *tables_[old_location.table], old_location.row, new_location.row
+         );
+         removeRow(old_location.table, old_location.row);
+      }
+
+      locations_.set(entity, new_location);
+   }
+
+   void ArchetypeChunkStore::removeRow(size_t table_index, size_t row)
+   {
+      const uid_t moved_entity = tables_[table_index]->removeRow(row);
+
+      if (moved_entity >= 0)
+      {
+         entity_location_t moved_location;
+         moved_location.table = table_index;
+         moved_location.row = row;
+         locations_.set(moved_entity, moved_location);
+      }
+   }
+}
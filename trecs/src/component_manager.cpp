@@ -3,10 +3,49 @@
 namespace trecs
 {
    ComponentManager::ComponentManager(size_t max_size)
+      : ComponentManager(max_size, PER_TYPE_POOLS, defaultMemoryResource())
+   { }
+
+   ComponentManager::ComponentManager(
+      size_t max_size, component_storage_enum_t storage
+   )
+      : ComponentManager(max_size, storage, defaultMemoryResource())
+   { }
+
+   ComponentManager::ComponentManager(
+      size_t max_size,
+      component_storage_enum_t storage,
+      IMemoryResource * resource
+   )
       : max_size_(max_size)
+      , storage_(storage)
+      , resource_(resource)
       , data_pools_(max_num_signatures)
+      , chunks_(
+         (storage == ARCHETYPE_CHUNKS) ?
+            new ArchetypeChunkStore(default_chunk_size_bytes, resource) :
+            nullptr
+      )
    { }
 
+   ComponentManager::ComponentManager(const ComponentManager & other)
+      : ComponentManager(other.max_size_, PER_TYPE_POOLS, other.resource_)
+   {
+      *this = other;
+   }
+
+   ComponentManager::ComponentManager(ComponentManager && other)
+      : ComponentManager(other.max_size_, PER_TYPE_POOLS, other.resource_)
+   {
+      *this = other;
+   }
+
+   ComponentManager & ComponentManager::operator=(ComponentManager && other)
+   {
+      ComponentManager & other_ref = other;
+      return *this = other_ref;
+   }
+
    // Moves ownership of the allocator buffers from the source ComponentManager
    // to this ComponentManager. Change of ownership requires the source to be
    // non-const.
@@ -20,6 +59,8 @@ namespace trecs
       }
 
       max_size_ = other.max_size_;
+      storage_ = other.storage_;
+      resource_ = other.resource_;
       signatures_ = other.signatures_;
 
       // Free all of the underlying data.
@@ -45,6 +86,8 @@ namespace trecs
          }
       }
 
+      chunks_.reset(other.chunks_.release());
+
       return *this;
    }
 
@@ -62,6 +105,8 @@ namespace trecs
       }
 
       max_size_ = other.max_size_;
+      storage_ = other.storage_;
+      resource_ = other.resource_;
       signatures_ = other.signatures_;
 
       // Free all of the underlying data.
@@ -87,11 +132,18 @@ namespace trecs
          }
       }
 
+      chunks_.reset(other.chunks_.get());
+
       return *this;
    }
 
    void ComponentManager::clear(void)
    {
+      if (chunks_ != nullptr)
+      {
+         chunks_->clear();
+      }
+
       for (auto & allocator : data_pools_)
       {
          if (allocator != nullptr)
@@ -110,10 +162,17 @@ namespace trecs
             allocator.release();
          }
       }
+
+      chunks_.release();
    }
 
    void ComponentManager::removeComponents(uid_t removed_components_uid)
    {
+      if (chunks_ != nullptr)
+      {
+         chunks_->removeComponents(removed_components_uid);
+      }
+
       for (auto & alloc : data_pools_)
       {
          if (alloc != nullptr)
@@ -123,6 +182,85 @@ namespace trecs
       }
    }
 
+   void ComponentManager::removeComponents(
+      Span<const uid_t> removed_components_uids,
+      const DefaultArchetype & arch
+   )
+   {
+      if (chunks_ != nullptr)
+      {
+         for (const auto uid : removed_components_uids)
+         {
+            chunks_->removeComponents(uid);
+         }
+      }
+
+      for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+      {
+         if (!arch.supports(sig) || data_pools_[sig] == nullptr)
+         {
+            continue;
+         }
+
+         for (const auto uid : removed_components_uids)
+         {
+            data_pools_[sig]->removeComponent(uid);
+         }
+      }
+   }
+
+   bool ComponentManager::placeEntities(
+      Span<const uid_t> entities, const DefaultArchetype & arch
+   )
+   {
+      if (storage_ != ARCHETYPE_CHUNKS)
+      {
+         return true;
+      }
+
+      return chunks_->addEntities(entities, arch);
+   }
+
+   void ComponentManager::sortByQuery(
+      const DefaultArchetype & query_arch,
+      const std::vector<uid_t> & entities
+   )
+   {
+      // Tags and chunk-stored objects don't have pools, so they're skipped.
+      for (signature_t sig = 0; sig < max_num_signatures; ++sig)
+      {
+         if (query_arch.supports(sig) && (data_pools_[sig] != nullptr))
+         {
+            data_pools_[sig]->reorder(entities);
+         }
+      }
+   }
+
+   std::vector<ArchetypeChunk *> ComponentManager::getChunks(
+      const DefaultArchetype & query_arch
+   ) const
+   {
+      if (chunks_ == nullptr)
+      {
+         return std::vector<ArchetypeChunk *>();
+      }
+
+      return chunks_->getChunks(query_arch);
+   }
+
+   std::vector<ArchetypeChunk *> ComponentManager::getChunks(
+      const DefaultArchetype & query_arch,
+      const DefaultArchetype & excluded_arch
+   ) const
+   {
+      if (chunks_ == nullptr)
+      {
+         return std::vector<ArchetypeChunk *>();
+      }
+
+      return chunks_->getChunks(query_arch, excluded_arch);
+   }
+
    // Returns the number of registered component signatures.
    size_t ComponentManager::getNumSignatures(void) const
    {
@@ -1,18 +1,29 @@
 #include "entity_manager.hpp"
 
-#include <algorithm>
 #include <cassert>
 #include <iostream>
 
 namespace trecs
 {
 
+   const size_t EntityManager::invalid_index_;
+
    EntityManager::EntityManager(uid_t max_entity_uid)
-      : meta_max_entity_uid_((1 << 20) - 2)
+      : EntityManager(max_entity_uid, REUSE_FREED_UIDS)
+   { }
+
+   EntityManager::EntityManager(
+      uid_t max_entity_uid, entity_uid_order_enum_t uid_order
+   )
+      : meta_max_entity_uid_(static_cast<uid_t>(0xffffffffu) - 1)
       , max_entity_uid_(
          max_entity_uid > meta_max_entity_uid_ ? meta_max_entity_uid_ : max_entity_uid
       )
-      , archetypes_(max_entity_uid_, DefaultArchetype())
+      , uid_order_(uid_order)
+      , next_unused_uid_(0)
+      , num_reserved_(0)
+      , num_disabled_(0)
+      , slots_(emptySlot())
    {
       assert(max_entity_uid_ >= 0);
 
@@ -21,11 +32,6 @@ namespace trecs
          std::cout << "Trying to allocate more than " << meta_max_entity_uid_ << " entities.\n";
          std::cout << "Capped max entity UID.\n";
       }
-
-      for (uid_t i = 0; i < max_entity_uid_; ++i)
-      {
-         uid_pool_.push_back(i);
-      }
    }
 
    EntityManager & EntityManager::operator=(const EntityManager & other)
@@ -36,65 +42,227 @@ namespace trecs
       }
 
       max_entity_uid_ = other.max_entity_uid_;
-      uid_pool_ = other.uid_pool_;
+      uid_order_ = other.uid_order_;
+      next_unused_uid_ = other.next_unused_uid_;
+      num_reserved_ = other.num_reserved_;
+      num_disabled_ = other.num_disabled_;
+      free_uids_ = other.free_uids_;
       uids_ = other.uids_;
-      archetypes_ = other.archetypes_;
+      slots_ = other.slots_;
 
       return *this;
    }
 
+   // Slots below the high-water mark are kept so that the generations of
+   // cleared entities stay stale.
    void EntityManager::clear(void)
    {
+      for (const auto uid : uids_)
+      {
+         entity_slot_t & slot = slots_.at(uid);
+         slot.dense_index = invalid_index_;
+         slot.archetype.reset();
+         ++slot.generation;
+      }
+
+      // Outstanding reservations are invalidated so that their UIDs can't
+      // be added after they've been handed out again.
+      if (num_reserved_ > 0)
+      {
+         for (uid_t uid = 0; uid < next_unused_uid_; ++uid)
+         {
+            if (slots_.get(uid).reserved)
+            {
+               slots_.at(uid).reserved = false;
+            }
+         }
+
+         num_reserved_ = 0;
+      }
+
       uids_.clear();
-      uid_pool_.clear();
+      free_uids_.clear();
+      next_unused_uid_ = 0;
+      num_disabled_ = 0;
+   }
 
-      for (uid_t i = 0; i < max_entity_uid_; ++i)
+   uid_t EntityManager::addEntity(void)
+   {
+      uid_t new_entity_uid = takeUid();
+      if (new_entity_uid < 0)
       {
-         uid_pool_.push_back(i);
+         return -1;
       }
 
-      for (uid_t i = 0; i < max_entity_uid_; ++i)
+      activate(new_entity_uid);
+
+      return new_entity_uid;
+   }
+
+   UidReservation EntityManager::reserveUids(size_t count)
+   {
+      const size_t num_unused = static_cast<size_t>(max_entity_uid_ - next_unused_uid_);
+      if (count > num_unused)
       {
-         archetypes_[i].reset();
+         count = num_unused;
       }
+
+      const uid_t first_uid = next_unused_uid_;
+      next_unused_uid_ += static_cast<uid_t>(count);
+
+      for (uid_t uid = first_uid; uid < next_unused_uid_; ++uid)
+      {
+         slots_.at(uid).reserved = true;
+      }
+
+      num_reserved_ += count;
+
+      return UidReservation(first_uid, next_unused_uid_);
    }
 
-   uid_t EntityManager::addEntity(void)
+   uid_t EntityManager::addReservedEntity(uid_t entity_uid)
    {
-      if (uid_pool_.size() == 0)
+      if (!slots_.get(entity_uid).reserved)
       {
+         std::cout << "Couldn't add entity UID " << entity_uid << " because it isn't reserved\n";
          return -1;
       }
 
-      uid_t new_entity_uid = uid_pool_.front();
-      uid_pool_.erase(uid_pool_.begin());
-      uids_.push_back(new_entity_uid);
+      slots_.at(entity_uid).reserved = false;
+      --num_reserved_;
+      activate(entity_uid);
 
-      archetypes_[new_entity_uid].reset();
+      return entity_uid;
+   }
 
-      return new_entity_uid;
+   void EntityManager::releaseReservation(UidReservation & reservation)
+   {
+      while (!reservation.empty())
+      {
+         releaseUid(reservation.takeUid());
+      }
    }
 
-   void EntityManager::removeEntity(uid_t removed_entity_uid)
+   void EntityManager::releaseUid(uid_t entity_uid)
    {
-      auto uids_it = std::find(
-         uids_.begin(), uids_.end(), removed_entity_uid
-      );
+      if (!slots_.get(entity_uid).reserved)
+      {
+         return;
+      }
 
-      if (uids_it == uids_.end())
+      slots_.at(entity_uid).reserved = false;
+      free_uids_.push_back(entity_uid);
+      --num_reserved_;
+   }
+
+   uid_t EntityManager::takeUid(void)
+   {
+      if ((uid_order_ == REUSE_FREED_UIDS) && !free_uids_.empty())
+      {
+         const uid_t uid = free_uids_.back();
+         free_uids_.pop_back();
+         return uid;
+      }
+
+      if (next_unused_uid_ < max_entity_uid_)
+      {
+         return next_unused_uid_++;
+      }
+
+      // Only reachable with the legacy order, which reuses freed UIDs
+      // first-in first-out once every UID has been handed out once.
+      if (free_uids_.empty())
+      {
+         return -1;
+      }
+
+      const uid_t uid = free_uids_.front();
+      free_uids_.pop_front();
+      return uid;
+   }
+
+   void EntityManager::activate(uid_t entity_uid)
+   {
+      entity_slot_t & slot = slots_.at(entity_uid);
+      slot.dense_index = uids_.size();
+      slot.enabled = true;
+      slot.archetype.reset();
+      uids_.push_back(entity_uid);
+   }
+
+   void EntityManager::removeEntity(uid_t removed_entity_uid)
+   {
+      if (!entityActive(removed_entity_uid))
       {
          return;
       }
 
-      uids_.erase(uids_it);
-      uid_pool_.push_back(removed_entity_uid);
+      // Move the last active UID into the removed UID's place.
+      entity_slot_t & removed_slot = slots_.at(removed_entity_uid);
+      if (!removed_slot.enabled)
+      {
+         --num_disabled_;
+      }
+
+      const uid_t last_entity_uid = uids_.back();
+      uids_[removed_slot.dense_index] = last_entity_uid;
+      slots_.at(last_entity_uid).dense_index = removed_slot.dense_index;
 
-      archetypes_[removed_entity_uid].reset();
+      uids_.pop_back();
+      removed_slot.dense_index = invalid_index_;
+      ++removed_slot.generation;
+      removed_slot.archetype.reset();
+      free_uids_.push_back(removed_entity_uid);
    }
 
    bool EntityManager::entityActive(uid_t entity_uid) const
    {
-      return std::find(uids_.begin(), uids_.end(), entity_uid) != uids_.end();
+      return slots_.get(entity_uid).dense_index != invalid_index_;
+   }
+
+   bool EntityManager::setEnabled(uid_t entity_uid, bool enabled)
+   {
+      if (!entityActive(entity_uid))
+      {
+         return false;
+      }
+
+      entity_slot_t & slot = slots_.at(entity_uid);
+      if (slot.enabled != enabled)
+      {
+         slot.enabled = enabled;
+         num_disabled_ = enabled ? (num_disabled_ - 1) : (num_disabled_ + 1);
+      }
+
+      return true;
+   }
+
+   bool EntityManager::entityEnabled(uid_t entity_uid) const
+   {
+      const entity_slot_t & slot = slots_.get(entity_uid);
+      return (slot.dense_index != invalid_index_) && slot.enabled;
+   }
+
+   entity_handle_t EntityManager::getHandle(uid_t entity_uid) const
+   {
+      if (!entityActive(entity_uid))
+      {
+         return error_entity_handle;
+      }
+
+      return makeEntityHandle(entity_uid, slots_.get(entity_uid).generation);
+   }
+
+   // A slot's generation moves on when its entity is removed, so handles to
+   // removed entities fail the generation comparison.
+   bool EntityManager::handleValid(entity_handle_t handle) const
+   {
+      const entity_slot_t & slot = slots_.get(handle.uid());
+
+      return (
+         (slot.generation == handle.generation()) &&
+         (slot.dense_index != invalid_index_)
+      );
    }
 
    const std::vector<uid_t> & EntityManager::getUids(void) const
@@ -106,13 +274,13 @@ namespace trecs
       uid_t entity_uid, const DefaultArchetype & archetype
    )
    {
-      if (std::find(uids_.begin(), uids_.end(), entity_uid) == uids_.end())
+      if (!entityActive(entity_uid))
       {
          std::cout << "Attempting to set the archetype of a non-existent entity\n";
          return false;
       }
 
-      archetypes_[entity_uid] = archetype;
+      slots_.at(entity_uid).archetype = archetype;
       return true;
    }
 
@@ -120,31 +288,31 @@ namespace trecs
       uid_t entity_uid, signature_t component_sig
    )
    {
-      if (std::find(uids_.begin(), uids_.end(), entity_uid) == uids_.end())
+      if (!entityActive(entity_uid))
       {
          std::cout << "Attempting to modify the archetype of a non-existent entity\n";
          return;
       }
 
-      archetypes_[entity_uid].mergeSignature(component_sig);
+      slots_.at(entity_uid).archetype.mergeSignature(component_sig);
    }
 
    void EntityManager::removeComponentSignature(
       uid_t entity_uid, signature_t component_sig
    )
    {
-      if (std::find(uids_.begin(), uids_.end(), entity_uid) == uids_.end())
+      if (!entityActive(entity_uid))
       {
          std::cout << "Attempting to modify the archetype of a non-existent entity\n";
          return;
       }
 
-      archetypes_[entity_uid].removeSignature(component_sig);
+      slots_.at(entity_uid).archetype.removeSignature(component_sig);
    }
 
    DefaultArchetype EntityManager::getArchetype(uid_t entity_uid) const
    {
-      return archetypes_[entity_uid];
+      return slots_.get(entity_uid).archetype;
    }
 
    std::size_t EntityManager::size(void) const
@@ -152,4 +320,19 @@ namespace trecs
       return uids_.size();
    }
 
+   EntityManager::entity_slot_t EntityManager::emptySlot(void)
+   {
+      entity_slot_t slot;
+      slot.dense_index = invalid_index_;
+      slot.generation = 0;
+      slot.enabled = false;
+      slot.reserved = false;
+      return slot;
+   }
+
+   std::size_t EntityManager::numAvailable(void) const
+   {
+      return free_uids_.size() + (max_entity_uid_ - next_unused_uid_);
+   }
+
 }
@@ -0,0 +1,234 @@
+#include "memory_resource.hpp"
+
+#include <cstdint>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace trecs
+{
+   namespace
+   {
+      // Huge pages on x86-64 and aarch64 Linux are 2 MiB.
+      const size_t huge_page_size_bytes = 2 * 1024 * 1024;
+
+      size_t alignUp(size_t value, size_t alignment)
+      {
+         return (value + alignment - 1) & ~(alignment - 1);
+      }
+   }
+
+   // The aligned block is preceded by the pointer that was returned by
+   // operator new so that the block can be freed later.
+   void * NewDeleteMemoryResource::allocate(size_t num_bytes, size_t alignment)
+   {
+      if (alignment < alignof(void *))
+      {
+         alignment = alignof(void *);
+      }
+
+      unsigned char * raw = static_cast<unsigned char *>(
+         ::operator new(num_bytes + alignment + sizeof(void *), std::nothrow)
+      );
+
+      if (raw == nullptr)
+      {
+         return nullptr;
+      }
+
+      const uintptr_t aligned = alignUp(
+         reinterpret_cast<uintptr_t>(raw) + sizeof(void *), alignment
+      );
+
+      reinterpret_cast<void **>(aligned)[-1] = raw;
+
+      return reinterpret_cast<void *>(aligned);
+   }
+
+   void NewDeleteMemoryResource::deallocate(
+      void * ptr, size_t num_bytes, size_t alignment
+   )
+   {
+      (void)num_bytes;
+      (void)alignment;
+
+      if (ptr == nullptr)
+      {
+         return;
+      }
+
+      ::operator delete(static_cast<void **>(ptr)[-1]);
+   }
+
+   IMemoryResource * defaultMemoryResource(void)
+   {
+      static NewDeleteMemoryResource resource;
+      return &resource;
+   }
+
+   ArenaMemoryResource::ArenaMemoryResource(size_t capacity_bytes)
+      : ArenaMemoryResource(capacity_bytes, defaultMemoryResource())
+   { }
+
+   ArenaMemoryResource::ArenaMemoryResource(
+      size_t capacity_bytes, IMemoryResource * upstream
+   )
+      : upstream_(upstream)
+      , capacity_bytes_(capacity_bytes)
+      , region_(nullptr)
+      , offset_(0)
+      , huge_pages_(false)
+   {
+      reserveRegion();
+   }
+
+   ArenaMemoryResource::~ArenaMemoryResource(void)
+   {
+      release();
+
+      if (region_ == nullptr)
+      {
+         return;
+      }
+
+#if defined(__linux__)
+      munmap(region_, capacity_bytes_);
+#else
+      delete [] region_;
+#endif
+      region_ = nullptr;
+   }
+
+   void * ArenaMemoryResource::allocate(size_t num_bytes, size_t alignment)
+   {
+      if (region_ != nullptr)
+      {
+         const uintptr_t base = reinterpret_cast<uintptr_t>(region_);
+         const size_t aligned_offset = alignUp(base + offset_, alignment) - base;
+
+         if (
+            (aligned_offset <= capacity_bytes_) &&
+            (num_bytes <= capacity_bytes_ - aligned_offset)
+         )
+         {
+            offset_ = aligned_offset + num_bytes;
+            return region_ + aligned_offset;
+         }
+      }
+
+      void * ptr = upstream_->allocate(num_bytes, alignment);
+      if (ptr != nullptr)
+      {
+         upstream_allocation_t allocation = {ptr, num_bytes, alignment};
+         upstream_allocations_.push_back(allocation);
+      }
+
+      return ptr;
+   }
+
+   void ArenaMemoryResource::deallocate(
+      void * ptr, size_t num_bytes, size_t alignment
+   )
+   {
+      if (ptr == nullptr || owns(ptr))
+      {
+         return;
+      }
+
+      // Recently allocated blocks are the most likely to be freed first.
+      for (size_t i = upstream_allocations_.size(); i > 0; --i)
+      {
+         if (upstream_allocations_[i - 1].ptr == ptr)
+         {
+            upstream_allocations_[i - 1] = upstream_allocations_.back();
+            upstream_allocations_.pop_back();
+            break;
+         }
+      }
+
+      upstream_->deallocate(ptr, num_bytes, alignment);
+   }
+
+   void ArenaMemoryResource::release(void)
+   {
+      for (const auto & allocation : upstream_allocations_)
+      {
+         upstream_->deallocate(
+            allocation.ptr, allocation.num_bytes, allocation.alignment
+         );
+      }
+
+      upstream_allocations_.clear();
+      offset_ = 0;
+   }
+
+   bool ArenaMemoryResource::owns(const void * ptr) const
+   {
+      const unsigned char * byte_ptr = static_cast<const unsigned char *>(ptr);
+      return (
+         (region_ != nullptr) &&
+         (byte_ptr >= region_) &&
+         (byte_ptr < region_ + capacity_bytes_)
+      );
+   }
+
+   void ArenaMemoryResource::reserveRegion(void)
+   {
+      if (capacity_bytes_ == 0)
+      {
+         return;
+      }
+
+#if defined(__linux__)
+      capacity_bytes_ = alignUp(capacity_bytes_, huge_page_size_bytes);
+
+      // Over-reserve by one huge page so that the region can start on a huge
+      // page boundary, then unmap the unused head and tail.
+      const size_t mapping_bytes = capacity_bytes_ + huge_page_size_bytes;
+      void * mapping = mmap(
+         nullptr,
+         mapping_bytes,
+         PROT_READ | PROT_WRITE,
+         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+         -1,
+         0
+      );
+
+      if (mapping == MAP_FAILED)
+      {
+         capacity_bytes_ = 0;
+         return;
+      }
+
+      unsigned char * mapping_start = static_cast<unsigned char *>(mapping);
+      region_ = reinterpret_cast<unsigned char *>(
+         alignUp(reinterpret_cast<uintptr_t>(mapping_start), huge_page_size_bytes)
+      );
+
+      const size_t head_bytes = static_cast<size_t>(region_ - mapping_start);
+      const size_t tail_bytes = mapping_bytes - head_bytes - capacity_bytes_;
+
+      if (head_bytes > 0)
+      {
+         munmap(mapping_start, head_bytes);
+      }
+
+      if (tail_bytes > 0)
+      {
+         munmap(region_ + capacity_bytes_, tail_bytes);
+      }
+
+#if defined(MADV_HUGEPAGE)
+      huge_pages_ = (madvise(region_, capacity_bytes_, MADV_HUGEPAGE) == 0);
+#endif
+#else
+      region_ = new (std::nothrow) unsigned char[capacity_bytes_];
+      if (region_ == nullptr)
+      {
+         capacity_bytes_ = 0;
+      }
+#endif
+   }
+}